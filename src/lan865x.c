@@ -8,6 +8,10 @@
 #include <linux/module.h>
 #include <linux/kernel.h>
 #include <linux/phy.h>
+#include <linux/rtnetlink.h>
+#include <linux/uaccess.h>
+#include <net/pkt_sched.h>
+#include "lan865x_ptp.h"
 #include "oa_tc6.h"
 
 #define DRV_NAME			"lan865x"
@@ -27,19 +31,98 @@
 #define LAN865X_REG_MAC_L_SADDR1	0x00010022 /* MAC Specific Addr 1 Bottom Reg */
 #define LAN865X_REG_MAC_H_SADDR1	0x00010023 /* MAC Specific Addr 1 Top Reg */
 
+/* MAC statistics counters, time stamping unit and event timestamps */
+#define LAN865X_REG_MAC_VOLATILE_FIRST	0x00010040
+#define LAN865X_REG_MAC_VOLATILE_LAST	0x0001007F
+
+/* MAC statistics counters, cleared on read */
+#define LAN865X_REG_MAC_STATS		0x00010040
+
+/* The counters are collected periodically and on demand, but not more often
+ * than every second however many readers poll them.
+ */
+#define LAN865X_STATS_PERIOD		(30 * HZ)
+#define LAN865X_STATS_MIN_AGE		HZ
+
 /* LAN8650/1 configuration fixup from AN1760 */
 #define LAN865X_FIXUP_REG		0x00010077
 #define LAN865X_FIXUP_VALUE		0x0028
 
+/* A tx queue stopped for longer gets the MAC-PHY reset */
+#define LAN865X_TX_TIMEOUT		msecs_to_jiffies(250)
+/* A failed recovery is retried with a doubling delay, 6.3s in total */
+#define LAN865X_RESET_RETRIES		6
+#define LAN865X_RESET_BACKOFF		msecs_to_jiffies(100)
+
+#define LAN865X_PRIV_FLAG_TX_ZERO_COPY	BIT(0)
+#define LAN865X_PRIV_FLAG_TX_PACKING	BIT(1)
+
 /* OPEN Alliance Configuration Register #0 */
 #define OA_TC6_REG_CONFIG0		0x0004
 #define CONFIG0_ZARFE_ENABLE		BIT(12)
 
+/* MAC statistics counters in register order from LAN865X_REG_MAC_STATS */
+enum lan865x_mac_stat {
+	LAN865X_MAC_TX_OCTETS, /* Bits 31:0 */
+	LAN865X_MAC_TX_OCTETS_HI, /* Bits 47:32 */
+	LAN865X_MAC_TX_FRAMES,
+	LAN865X_MAC_TX_BCAST,
+	LAN865X_MAC_TX_MCAST,
+	LAN865X_MAC_TX_PAUSE,
+	LAN865X_MAC_TX_64,
+	LAN865X_MAC_TX_65_127,
+	LAN865X_MAC_TX_128_255,
+	LAN865X_MAC_TX_256_511,
+	LAN865X_MAC_TX_512_1023,
+	LAN865X_MAC_TX_1024_1518,
+	LAN865X_MAC_TX_1519_MAX,
+	LAN865X_MAC_TX_UNDERRUNS,
+	LAN865X_MAC_TX_SINGLE_COL,
+	LAN865X_MAC_TX_MULTI_COL,
+	LAN865X_MAC_TX_EXCESS_COL,
+	LAN865X_MAC_TX_LATE_COL,
+	LAN865X_MAC_TX_DEFERRED,
+	LAN865X_MAC_TX_CARRIER_SENSE,
+	LAN865X_MAC_RX_OCTETS, /* Bits 31:0 */
+	LAN865X_MAC_RX_OCTETS_HI, /* Bits 47:32 */
+	LAN865X_MAC_RX_FRAMES,
+	LAN865X_MAC_RX_BCAST,
+	LAN865X_MAC_RX_MCAST,
+	LAN865X_MAC_RX_PAUSE,
+	LAN865X_MAC_RX_64,
+	LAN865X_MAC_RX_65_127,
+	LAN865X_MAC_RX_128_255,
+	LAN865X_MAC_RX_256_511,
+	LAN865X_MAC_RX_512_1023,
+	LAN865X_MAC_RX_1024_1518,
+	LAN865X_MAC_RX_1519_MAX,
+	LAN865X_MAC_RX_UNDERSIZE,
+	LAN865X_MAC_RX_OVERSIZE,
+	LAN865X_MAC_RX_JABBERS,
+	LAN865X_MAC_RX_FCS,
+	LAN865X_MAC_RX_LENGTH,
+	LAN865X_MAC_RX_SYMBOL,
+	LAN865X_MAC_RX_ALIGN,
+	LAN865X_MAC_RX_RESOURCE,
+	LAN865X_MAC_RX_OVERRUNS,
+	LAN865X_MAC_RX_IP_CSUM,
+	LAN865X_MAC_RX_TCP_CSUM,
+	LAN865X_MAC_RX_UDP_CSUM,
+	LAN865X_MAC_STATS,
+};
+
 struct lan865x_priv {
 	struct work_struct multicast_work;
+	struct delayed_work reset_work;
+	struct delayed_work stats_work;
 	struct net_device *netdev;
 	struct spi_device *spi;
 	struct oa_tc6 *tc6;
+	struct lan865x_ptp ptp;
+	struct mutex stats_lock; /* Protects mac_stats and stats_updated */
+	u64 mac_stats[LAN865X_MAC_STATS]; /* The octets hold all 48 bits */
+	unsigned long stats_updated; /* In jiffies */
+	unsigned int reset_retries; /* Failed recoveries in a row */
 };
 
 static int lan865x_set_hw_macaddr_low_bytes(struct oa_tc6 *tc6, const u8 *mac)
@@ -79,6 +162,12 @@ static int lan865x_set_hw_macaddr(struct lan865x_priv *priv, const u8 *mac)
 	return ret;
 }
 
+static bool lan865x_volatile_reg(u32 address)
+{
+	return address >= LAN865X_REG_MAC_VOLATILE_FIRST &&
+	       address <= LAN865X_REG_MAC_VOLATILE_LAST;
+}
+
 static void
 lan865x_get_drvinfo(struct net_device *netdev, struct ethtool_drvinfo *info)
 {
@@ -87,10 +176,345 @@ lan865x_get_drvinfo(struct net_device *netdev, struct ethtool_drvinfo *info)
 		sizeof(info->bus_info));
 }
 
+static void
+lan865x_get_ringparam(struct net_device *netdev,
+		      struct ethtool_ringparam *ring,
+		      struct kernel_ethtool_ringparam *kernel_ring,
+		      struct netlink_ext_ack *extack)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+
+	ring->tx_max_pending = OA_TC6_TX_SKB_QUEUE_MAX_SIZE;
+	ring->tx_pending = oa_tc6_get_tx_queue_size(priv->tc6);
+}
+
+static int
+lan865x_set_ringparam(struct net_device *netdev,
+		      struct ethtool_ringparam *ring,
+		      struct kernel_ethtool_ringparam *kernel_ring,
+		      struct netlink_ext_ack *extack)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+
+	if (!ring->tx_pending) {
+		NL_SET_ERR_MSG(extack, "tx ring size must not be zero");
+		return -EINVAL;
+	}
+
+	return oa_tc6_set_tx_queue_size(priv->tc6, ring->tx_pending);
+}
+
+static const char lan865x_priv_flags_strings[][ETH_GSTRING_LEN] = {
+	"tx-zero-copy",
+	"tx-packing",
+};
+
+static const char lan865x_stats_strings[][ETH_GSTRING_LEN] = {
+	"spi_bus_time_ns",
+	"spi_bus_chunks",
+	"spi_bus_ctrl_transfers",
+	"spi_bus_share_percent",
+	"spi_data_transfers",
+	"spi_data_chunks",
+	"spi_tx_data_chunks",
+	"spi_rx_data_chunks",
+	"spi_empty_tx_chunks_percent",
+	"tx_credit_stalls",
+	"rx_buffer_overflows",
+	"extended_status_reads",
+	"ctrl_requests",
+	"ctrl_wait_ns",
+	"ctrl_wait_max_ns",
+	"ctrl_exec_ns",
+	"ctrl_exec_max_ns",
+	"err_loss_of_frame",
+	"err_header",
+	"err_rxd_header_bad",
+	"err_config_unsync",
+	"err_tx_protocol",
+	"err_footer_parity",
+	"recoveries",
+	"recovery_max_ns",
+	"resets",
+	"reset_max_ns",
+	"tx_tstamp_skipped",
+	"tx_tstamp_lost",
+	"err_rx_tstamp_parity",
+	"tx_launch_late",
+};
+
+/* MAC statistics counters reported by ethtool -S after the driver ones */
+static const struct {
+	char name[ETH_GSTRING_LEN];
+	enum lan865x_mac_stat stat;
+} lan865x_mac_stats[] = {
+	{ "mac_tx_octets", LAN865X_MAC_TX_OCTETS },
+	{ "mac_tx_frames", LAN865X_MAC_TX_FRAMES },
+	{ "mac_tx_broadcast", LAN865X_MAC_TX_BCAST },
+	{ "mac_tx_multicast", LAN865X_MAC_TX_MCAST },
+	{ "mac_tx_pause", LAN865X_MAC_TX_PAUSE },
+	{ "mac_tx_64", LAN865X_MAC_TX_64 },
+	{ "mac_tx_65_127", LAN865X_MAC_TX_65_127 },
+	{ "mac_tx_128_255", LAN865X_MAC_TX_128_255 },
+	{ "mac_tx_256_511", LAN865X_MAC_TX_256_511 },
+	{ "mac_tx_512_1023", LAN865X_MAC_TX_512_1023 },
+	{ "mac_tx_1024_1518", LAN865X_MAC_TX_1024_1518 },
+	{ "mac_tx_1519_max", LAN865X_MAC_TX_1519_MAX },
+	{ "mac_tx_underruns", LAN865X_MAC_TX_UNDERRUNS },
+	{ "mac_tx_single_collisions", LAN865X_MAC_TX_SINGLE_COL },
+	{ "mac_tx_multiple_collisions", LAN865X_MAC_TX_MULTI_COL },
+	{ "mac_tx_excessive_collisions", LAN865X_MAC_TX_EXCESS_COL },
+	{ "mac_tx_late_collisions", LAN865X_MAC_TX_LATE_COL },
+	{ "mac_tx_deferred", LAN865X_MAC_TX_DEFERRED },
+	{ "mac_tx_carrier_sense_errors", LAN865X_MAC_TX_CARRIER_SENSE },
+	{ "mac_rx_octets", LAN865X_MAC_RX_OCTETS },
+	{ "mac_rx_frames", LAN865X_MAC_RX_FRAMES },
+	{ "mac_rx_broadcast", LAN865X_MAC_RX_BCAST },
+	{ "mac_rx_multicast", LAN865X_MAC_RX_MCAST },
+	{ "mac_rx_pause", LAN865X_MAC_RX_PAUSE },
+	{ "mac_rx_64", LAN865X_MAC_RX_64 },
+	{ "mac_rx_65_127", LAN865X_MAC_RX_65_127 },
+	{ "mac_rx_128_255", LAN865X_MAC_RX_128_255 },
+	{ "mac_rx_256_511", LAN865X_MAC_RX_256_511 },
+	{ "mac_rx_512_1023", LAN865X_MAC_RX_512_1023 },
+	{ "mac_rx_1024_1518", LAN865X_MAC_RX_1024_1518 },
+	{ "mac_rx_1519_max", LAN865X_MAC_RX_1519_MAX },
+	{ "mac_rx_undersize", LAN865X_MAC_RX_UNDERSIZE },
+	{ "mac_rx_oversize", LAN865X_MAC_RX_OVERSIZE },
+	{ "mac_rx_jabbers", LAN865X_MAC_RX_JABBERS },
+	{ "mac_rx_fcs_errors", LAN865X_MAC_RX_FCS },
+	{ "mac_rx_length_errors", LAN865X_MAC_RX_LENGTH },
+	{ "mac_rx_symbol_errors", LAN865X_MAC_RX_SYMBOL },
+	{ "mac_rx_alignment_errors", LAN865X_MAC_RX_ALIGN },
+	{ "mac_rx_resource_errors", LAN865X_MAC_RX_RESOURCE },
+	{ "mac_rx_overruns", LAN865X_MAC_RX_OVERRUNS },
+	{ "mac_rx_ip_checksum_errors", LAN865X_MAC_RX_IP_CSUM },
+	{ "mac_rx_tcp_checksum_errors", LAN865X_MAC_RX_TCP_CSUM },
+	{ "mac_rx_udp_checksum_errors", LAN865X_MAC_RX_UDP_CSUM },
+};
+
+/* Reads all the MAC statistics counters in one burst and adds them up, as
+ * they are cleared on read.
+ */
+static int lan865x_collect_mac_stats(struct lan865x_priv *priv)
+{
+	u32 regs[LAN865X_MAC_STATS];
+	int ret;
+
+	lockdep_assert_held(&priv->stats_lock);
+
+	ret = oa_tc6_read_registers(priv->tc6, LAN865X_REG_MAC_STATS, regs,
+				    ARRAY_SIZE(regs));
+	if (ret)
+		return ret;
+
+	for (int i = 0; i < LAN865X_MAC_STATS; i++) {
+		if (i == LAN865X_MAC_TX_OCTETS_HI ||
+		    i == LAN865X_MAC_RX_OCTETS_HI)
+			priv->mac_stats[i - 1] += (u64)regs[i] << 32;
+		else
+			priv->mac_stats[i] += regs[i];
+	}
+	priv->stats_updated = jiffies;
+
+	return 0;
+}
+
+/* Readers get the cached counters if they were collected recently */
+static void lan865x_refresh_mac_stats(struct lan865x_priv *priv)
+{
+	lockdep_assert_held(&priv->stats_lock);
+
+	if (time_before(jiffies, priv->stats_updated + LAN865X_STATS_MIN_AGE))
+		return;
+
+	if (lan865x_collect_mac_stats(priv))
+		netdev_warn_once(priv->netdev,
+				 "Failed to read the MAC statistics\n");
+}
+
+static void lan865x_stats_work_handler(struct work_struct *work)
+{
+	struct lan865x_priv *priv = container_of(work, struct lan865x_priv,
+						 stats_work.work);
+
+	mutex_lock(&priv->stats_lock);
+	lan865x_refresh_mac_stats(priv);
+	mutex_unlock(&priv->stats_lock);
+
+	schedule_delayed_work(&priv->stats_work, LAN865X_STATS_PERIOD);
+}
+
+static void lan865x_get_eth_mac_stats(struct net_device *netdev,
+				      struct ethtool_eth_mac_stats *mac_stats)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+	u64 *stats = priv->mac_stats;
+
+	mutex_lock(&priv->stats_lock);
+	lan865x_refresh_mac_stats(priv);
+	mac_stats->FramesTransmittedOK = stats[LAN865X_MAC_TX_FRAMES];
+	mac_stats->SingleCollisionFrames = stats[LAN865X_MAC_TX_SINGLE_COL];
+	mac_stats->MultipleCollisionFrames = stats[LAN865X_MAC_TX_MULTI_COL];
+	mac_stats->FramesReceivedOK = stats[LAN865X_MAC_RX_FRAMES];
+	mac_stats->FrameCheckSequenceErrors = stats[LAN865X_MAC_RX_FCS];
+	mac_stats->AlignmentErrors = stats[LAN865X_MAC_RX_ALIGN];
+	mac_stats->OctetsTransmittedOK = stats[LAN865X_MAC_TX_OCTETS];
+	mac_stats->FramesWithDeferredXmissions = stats[LAN865X_MAC_TX_DEFERRED];
+	mac_stats->LateCollisions = stats[LAN865X_MAC_TX_LATE_COL];
+	mac_stats->FramesAbortedDueToXSColls = stats[LAN865X_MAC_TX_EXCESS_COL];
+	mac_stats->FramesLostDueToIntMACXmitError =
+		stats[LAN865X_MAC_TX_UNDERRUNS];
+	mac_stats->CarrierSenseErrors = stats[LAN865X_MAC_TX_CARRIER_SENSE];
+	mac_stats->OctetsReceivedOK = stats[LAN865X_MAC_RX_OCTETS];
+	mac_stats->FramesLostDueToIntMACRcvError =
+		stats[LAN865X_MAC_RX_OVERRUNS];
+	mac_stats->MulticastFramesXmittedOK = stats[LAN865X_MAC_TX_MCAST];
+	mac_stats->BroadcastFramesXmittedOK = stats[LAN865X_MAC_TX_BCAST];
+	mac_stats->MulticastFramesReceivedOK = stats[LAN865X_MAC_RX_MCAST];
+	mac_stats->BroadcastFramesReceivedOK = stats[LAN865X_MAC_RX_BCAST];
+	mac_stats->InRangeLengthErrors = stats[LAN865X_MAC_RX_LENGTH];
+	mac_stats->FrameTooLongErrors = stats[LAN865X_MAC_RX_OVERSIZE];
+	mutex_unlock(&priv->stats_lock);
+}
+
+static int lan865x_get_sset_count(struct net_device *netdev, int sset)
+{
+	switch (sset) {
+	case ETH_SS_STATS:
+		return ARRAY_SIZE(lan865x_stats_strings) +
+		       ARRAY_SIZE(lan865x_mac_stats);
+	case ETH_SS_PRIV_FLAGS:
+		return ARRAY_SIZE(lan865x_priv_flags_strings);
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+
+static void lan865x_get_strings(struct net_device *netdev, u32 sset, u8 *data)
+{
+	switch (sset) {
+	case ETH_SS_STATS:
+		memcpy(data, lan865x_stats_strings,
+		       sizeof(lan865x_stats_strings));
+		data += sizeof(lan865x_stats_strings);
+		for (int i = 0; i < ARRAY_SIZE(lan865x_mac_stats); i++)
+			ethtool_sprintf(&data, "%s", lan865x_mac_stats[i].name);
+		break;
+	case ETH_SS_PRIV_FLAGS:
+		memcpy(data, lan865x_priv_flags_strings,
+		       sizeof(lan865x_priv_flags_strings));
+		break;
+	}
+}
+
+static void lan865x_get_ethtool_stats(struct net_device *netdev,
+				      struct ethtool_stats *stats, u64 *data)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+	struct oa_tc6_error_stats err_stats;
+	struct oa_tc6_data_stats data_stats;
+	struct oa_tc6_ctrl_stats ctrl_stats;
+	struct oa_tc6_bus_stats bus_stats;
+
+	oa_tc6_get_bus_stats(priv->tc6, &bus_stats);
+	oa_tc6_get_data_stats(priv->tc6, &data_stats);
+	oa_tc6_get_ctrl_stats(priv->tc6, &ctrl_stats);
+	oa_tc6_get_error_stats(priv->tc6, &err_stats);
+
+	*data++ = bus_stats.port_time_ns;
+	*data++ = bus_stats.port_chunks;
+	*data++ = bus_stats.port_ctrl_xfers;
+	*data++ = bus_stats.bus_time_ns ?
+		  div64_u64(bus_stats.port_time_ns * 100,
+			    bus_stats.bus_time_ns) : 0;
+	*data++ = data_stats.xfers;
+	*data++ = data_stats.chunks;
+	*data++ = data_stats.tx_chunks;
+	*data++ = data_stats.rx_chunks;
+	*data++ = data_stats.chunks ?
+		  div64_u64((data_stats.chunks - data_stats.tx_chunks) * 100,
+			    data_stats.chunks) : 0;
+	*data++ = data_stats.tx_credit_stalls;
+	*data++ = data_stats.rx_buf_overflows;
+	*data++ = data_stats.ext_status_reads;
+	*data++ = ctrl_stats.reqs;
+	*data++ = ctrl_stats.wait_ns;
+	*data++ = ctrl_stats.wait_max_ns;
+	*data++ = ctrl_stats.exec_ns;
+	*data++ = ctrl_stats.exec_max_ns;
+	*data++ = err_stats.loss_of_frame;
+	*data++ = err_stats.header_error;
+	*data++ = err_stats.rxd_header_bad;
+	*data++ = err_stats.config_unsync;
+	*data++ = err_stats.tx_protocol_error;
+	*data++ = err_stats.footer_parity;
+	*data++ = err_stats.recoveries;
+	*data++ = err_stats.recovery_max_ns;
+	*data++ = err_stats.resets;
+	*data++ = err_stats.reset_max_ns;
+	*data++ = err_stats.tx_tstamp_skipped;
+	*data++ = err_stats.tx_tstamp_lost;
+	*data++ = err_stats.rx_tstamp_parity;
+	*data++ = err_stats.tx_launch_late;
+
+	mutex_lock(&priv->stats_lock);
+	lan865x_refresh_mac_stats(priv);
+	for (int i = 0; i < ARRAY_SIZE(lan865x_mac_stats); i++)
+		*data++ = priv->mac_stats[lan865x_mac_stats[i].stat];
+	mutex_unlock(&priv->stats_lock);
+}
+
+static u32 lan865x_get_priv_flags(struct net_device *netdev)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+	u32 flags = 0;
+
+	if (oa_tc6_get_tx_zero_copy(priv->tc6))
+		flags |= LAN865X_PRIV_FLAG_TX_ZERO_COPY;
+	if (oa_tc6_get_tx_packing(priv->tc6))
+		flags |= LAN865X_PRIV_FLAG_TX_PACKING;
+
+	return flags;
+}
+
+static int lan865x_set_priv_flags(struct net_device *netdev, u32 flags)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+	int ret;
+
+	ret = oa_tc6_set_tx_packing(priv->tc6,
+				    flags & LAN865X_PRIV_FLAG_TX_PACKING);
+	if (ret)
+		return ret;
+
+	oa_tc6_set_tx_zero_copy(priv->tc6,
+				flags & LAN865X_PRIV_FLAG_TX_ZERO_COPY);
+
+	return 0;
+}
+
+static int lan865x_get_ts_info(struct net_device *netdev,
+			       struct lan865x_ts_info *info)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+
+	return lan865x_ptp_get_ts_info(&priv->ptp, info);
+}
+
 static const struct ethtool_ops lan865x_ethtool_ops = {
 	.get_drvinfo        = lan865x_get_drvinfo,
 	.get_link_ksettings = phy_ethtool_get_link_ksettings,
 	.set_link_ksettings = phy_ethtool_set_link_ksettings,
+	.get_ringparam      = lan865x_get_ringparam,
+	.set_ringparam      = lan865x_set_ringparam,
+	.get_sset_count     = lan865x_get_sset_count,
+	.get_strings        = lan865x_get_strings,
+	.get_ethtool_stats  = lan865x_get_ethtool_stats,
+	.get_eth_mac_stats  = lan865x_get_eth_mac_stats,
+	.get_priv_flags     = lan865x_get_priv_flags,
+	.set_priv_flags     = lan865x_set_priv_flags,
+	.get_ts_info        = lan865x_get_ts_info,
 };
 
 static int lan865x_set_mac_address(struct net_device *netdev, void *addr)
@@ -120,9 +544,9 @@ static u32 lan865x_hash(u8 addr[ETH_ALEN])
 	return (ether_crc(ETH_ALEN, addr) >> 26) & GENMASK(5, 0);
 }
 
-static void lan865x_set_specific_multicast_addr(struct net_device *netdev)
+static void lan865x_set_specific_multicast_addr(struct net_device *netdev,
+						struct oa_tc6_txn *txn)
 {
-	struct lan865x_priv *priv = netdev_priv(netdev);
 	struct netdev_hw_addr *ha;
 	u32 hash_lo = 0;
 	u32 hash_hi = 0;
@@ -141,21 +565,19 @@ static void lan865x_set_specific_multicast_addr(struct net_device *netdev)
 	}
 
 	/* Enabling specific multicast addresses */
-	if (oa_tc6_write_register(priv->tc6, LAN865X_REG_MAC_H_HASH, hash_hi)) {
-		netdev_err(netdev, "Failed to write reg_hashh");
-		return;
-	}
-
-	if (oa_tc6_write_register(priv->tc6, LAN865X_REG_MAC_L_HASH, hash_lo))
-		netdev_err(netdev, "Failed to write reg_hashl");
+	oa_tc6_txn_write(txn, LAN865X_REG_MAC_H_HASH, hash_hi);
+	oa_tc6_txn_write(txn, LAN865X_REG_MAC_L_HASH, hash_lo);
 }
 
-static void lan865x_multicast_work_handler(struct work_struct *work)
+static int lan865x_set_rx_mode(struct lan865x_priv *priv,
+			       enum oa_tc6_ctrl_prio prio)
 {
-	struct lan865x_priv *priv = container_of(work, struct lan865x_priv,
-						 multicast_work);
+	struct oa_tc6_txn txn;
 	u32 regval = 0;
 
+	/* The hash and mode registers are written in one control transfer */
+	oa_tc6_txn_init(&txn);
+
 	if (priv->netdev->flags & IFF_PROMISC) {
 		/* Enabling promiscuous mode */
 		regval |= MAC_NET_CFG_PROMISCUOUS_MODE;
@@ -167,22 +589,27 @@ static void lan865x_multicast_work_handler(struct work_struct *work)
 		regval |= MAC_NET_CFG_MULTICAST_MODE;
 		regval &= (~MAC_NET_CFG_UNICAST_MODE);
 	} else if (!netdev_mc_empty(priv->netdev)) {
-		lan865x_set_specific_multicast_addr(priv->netdev);
+		lan865x_set_specific_multicast_addr(priv->netdev, &txn);
 		regval &= (~MAC_NET_CFG_PROMISCUOUS_MODE);
 		regval &= (~MAC_NET_CFG_MULTICAST_MODE);
 		regval |= MAC_NET_CFG_UNICAST_MODE;
 	} else {
 		/* enabling local mac address only */
-		if (oa_tc6_write_register(priv->tc6, LAN865X_REG_MAC_H_HASH, 0)) {
-			netdev_err(priv->netdev, "Failed to write reg_hashh");
-			return;
-		}
-		if (oa_tc6_write_register(priv->tc6, LAN865X_REG_MAC_L_HASH, 0)) {
-			netdev_err(priv->netdev, "Failed to write reg_hashl");
-			return;
-		}
+		oa_tc6_txn_write(&txn, LAN865X_REG_MAC_H_HASH, 0);
+		oa_tc6_txn_write(&txn, LAN865X_REG_MAC_L_HASH, 0);
 	}
-	if (oa_tc6_write_register(priv->tc6, LAN865X_REG_MAC_NET_CFG, regval))
+	oa_tc6_txn_write(&txn, LAN865X_REG_MAC_NET_CFG, regval);
+
+	return oa_tc6_txn_execute(priv->tc6, &txn, prio);
+}
+
+static void lan865x_multicast_work_handler(struct work_struct *work)
+{
+	struct lan865x_priv *priv = container_of(work, struct lan865x_priv,
+						 multicast_work);
+
+	/* Not urgent enough to hold up the data transfers */
+	if (lan865x_set_rx_mode(priv, OA_TC6_CTRL_PRIO_LOW))
 		netdev_err(priv->netdev,
 			   "Failed to enable promiscuous/multicast/normal mode");
 }
@@ -204,14 +631,8 @@ static netdev_tx_t lan865x_send_packet(struct sk_buff *skb,
 
 static int lan865x_hw_disable(struct lan865x_priv *priv)
 {
-	u32 regval;
-
-	if (oa_tc6_read_register(priv->tc6, LAN865X_REG_MAC_NET_CTL, &regval))
-		return -ENODEV;
-
-	regval &= ~(MAC_NET_CTL_TXEN | MAC_NET_CTL_RXEN);
-
-	if (oa_tc6_write_register(priv->tc6, LAN865X_REG_MAC_NET_CTL, regval))
+	if (oa_tc6_update_register(priv->tc6, LAN865X_REG_MAC_NET_CTL,
+				   MAC_NET_CTL_TXEN | MAC_NET_CTL_RXEN, 0))
 		return -ENODEV;
 
 	return 0;
@@ -224,6 +645,7 @@ static int lan865x_net_close(struct net_device *netdev)
 
 	netif_stop_queue(netdev);
 	phy_stop(netdev->phydev);
+	cancel_delayed_work_sync(&priv->stats_work);
 	ret = lan865x_hw_disable(priv);
 	if (ret) {
 		netdev_err(netdev, "Failed to disable the hardware: %d\n", ret);
@@ -235,14 +657,9 @@ static int lan865x_net_close(struct net_device *netdev)
 
 static int lan865x_hw_enable(struct lan865x_priv *priv)
 {
-	u32 regval;
-
-	if (oa_tc6_read_register(priv->tc6, LAN865X_REG_MAC_NET_CTL, &regval))
-		return -ENODEV;
-
-	regval |= MAC_NET_CTL_TXEN | MAC_NET_CTL_RXEN;
-
-	if (oa_tc6_write_register(priv->tc6, LAN865X_REG_MAC_NET_CTL, regval))
+	if (oa_tc6_update_register(priv->tc6, LAN865X_REG_MAC_NET_CTL,
+				   MAC_NET_CTL_TXEN | MAC_NET_CTL_RXEN,
+				   MAC_NET_CTL_TXEN | MAC_NET_CTL_RXEN))
 		return -ENODEV;
 
 	return 0;
@@ -260,16 +677,110 @@ static int lan865x_net_open(struct net_device *netdev)
 	}
 
 	phy_start(netdev->phydev);
+	schedule_delayed_work(&priv->stats_work, LAN865X_STATS_PERIOD);
+
+	return 0;
+}
+
+static int lan865x_hwtstamp_set(struct lan865x_priv *priv, struct ifreq *rq)
+{
+	struct hwtstamp_config config;
+	int ret;
+
+	if (copy_from_user(&config, rq->ifr_data, sizeof(config)))
+		return -EFAULT;
+
+	ret = oa_tc6_hwtstamp_set(priv->tc6, &config);
+	if (ret)
+		return ret;
+
+	return copy_to_user(rq->ifr_data, &config, sizeof(config)) ?
+	       -EFAULT : 0;
+}
+
+static int lan865x_hwtstamp_get(struct lan865x_priv *priv, struct ifreq *rq)
+{
+	struct hwtstamp_config config;
+
+	oa_tc6_hwtstamp_get(priv->tc6, &config);
+
+	return copy_to_user(rq->ifr_data, &config, sizeof(config)) ?
+	       -EFAULT : 0;
+}
+
+static int lan865x_eth_ioctl(struct net_device *netdev, struct ifreq *rq,
+			     int cmd)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+
+	switch (cmd) {
+	case SIOCSHWTSTAMP:
+		return lan865x_hwtstamp_set(priv, rq);
+	case SIOCGHWTSTAMP:
+		return lan865x_hwtstamp_get(priv, rq);
+	default:
+		return phy_do_ioctl_running(netdev, rq, cmd);
+	}
+}
+
+static void lan865x_get_stats64(struct net_device *netdev,
+				struct rtnl_link_stats64 *stats)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+
+	oa_tc6_get_stats64(priv->tc6, stats);
+}
+
+static int lan865x_setup_etf(struct lan865x_priv *priv,
+			     struct tc_etf_qopt_offload *qopt)
+{
+	int ret;
+
+	/* The one tx queue */
+	if (qopt->queue)
+		return -EINVAL;
+
+	ret = lan865x_ptp_set_launch_time(&priv->ptp, qopt->enable);
+	if (ret)
+		return ret;
+
+	oa_tc6_set_launch_time(priv->tc6, qopt->enable);
 
 	return 0;
 }
 
+static int lan865x_setup_tc(struct net_device *netdev, enum tc_setup_type type,
+			    void *type_data)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+
+	switch (type) {
+	case TC_SETUP_QDISC_ETF:
+		return lan865x_setup_etf(priv, type_data);
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+
+static void lan865x_tx_timeout(struct net_device *netdev,
+			       unsigned int txqueue)
+{
+	struct lan865x_priv *priv = netdev_priv(netdev);
+
+	/* The tx credits never came back or the SPI data transfers stopped */
+	schedule_delayed_work(&priv->reset_work, 0);
+}
+
 static const struct net_device_ops lan865x_netdev_ops = {
 	.ndo_open		= lan865x_net_open,
 	.ndo_stop		= lan865x_net_close,
 	.ndo_start_xmit		= lan865x_send_packet,
+	.ndo_tx_timeout		= lan865x_tx_timeout,
 	.ndo_set_rx_mode	= lan865x_set_multicast_list,
 	.ndo_set_mac_address	= lan865x_set_mac_address,
+	.ndo_get_stats64	= lan865x_get_stats64,
+	.ndo_eth_ioctl		= lan865x_eth_ioctl,
+	.ndo_setup_tc		= lan865x_setup_tc,
 };
 
 static int lan865x_configure_fixup(struct lan865x_priv *priv)
@@ -280,23 +791,90 @@ static int lan865x_configure_fixup(struct lan865x_priv *priv)
 
 static int lan865x_set_zarfe(struct lan865x_priv *priv)
 {
-	u32 regval;
+	/* Set Zero-Align Receive Frame Enable */
+	return oa_tc6_update_register(priv->tc6, OA_TC6_REG_CONFIG0,
+				      CONFIG0_ZARFE_ENABLE, CONFIG0_ZARFE_ENABLE);
+}
+
+/* Everything the MAC-PHY loses on a reset, besides the standard and the PHY
+ * configuration restored by the OPEN Alliance TC6 lib.
+ */
+static int lan865x_replay_config(struct lan865x_priv *priv)
+{
 	int ret;
 
-	ret = oa_tc6_read_register(priv->tc6, OA_TC6_REG_CONFIG0, &regval);
+	ret = lan865x_configure_fixup(priv);
 	if (ret)
 		return ret;
 
-	/* Set Zero-Align Receive Frame Enable */
-	regval |= CONFIG0_ZARFE_ENABLE;
+	/* The fixup sets the nominal timer increment */
+	ret = lan865x_ptp_restore(&priv->ptp);
+	if (ret)
+		return ret;
+
+	ret = lan865x_set_zarfe(priv);
+	if (ret)
+		return ret;
+
+	ret = lan865x_set_hw_macaddr(priv, priv->netdev->dev_addr);
+	if (ret)
+		return ret;
+
+	ret = lan865x_set_rx_mode(priv, OA_TC6_CTRL_PRIO_NORMAL);
+	if (ret)
+		return ret;
+
+	return lan865x_hw_enable(priv);
+}
+
+static void lan865x_reset_work_handler(struct work_struct *work)
+{
+	struct lan865x_priv *priv = container_of(work, struct lan865x_priv,
+						 reset_work.work);
+	struct net_device *netdev = priv->netdev;
+	int ret;
+
+	rtnl_lock();
+
+	if (!netif_running(netdev)) {
+		priv->reset_retries = 0;
+		goto unlock;
+	}
+
+	/* The link goes down meanwhile, which keeps the watchdog quiet */
+	phy_stop(netdev->phydev);
+
+	ret = oa_tc6_reset_macphy(priv->tc6);
+	if (!ret)
+		ret = lan865x_replay_config(priv);
+	if (!ret)
+		ret = oa_tc6_restart_data(priv->tc6);
+
+	/* The carrier stays down, so the watchdog won't ask again */
+	if (ret && ++priv->reset_retries < LAN865X_RESET_RETRIES) {
+		netdev_warn(netdev, "MAC-PHY recovery failed: %d, retrying\n",
+			    ret);
+		schedule_delayed_work(&priv->reset_work, LAN865X_RESET_BACKOFF <<
+				      (priv->reset_retries - 1));
+		goto unlock;
+	}
 
-	return oa_tc6_write_register(priv->tc6, OA_TC6_REG_CONFIG0, regval);
+	/* Otherwise left to the watchdog, which fires again once the link is up */
+	if (ret)
+		netdev_err(netdev, "MAC-PHY recovery failed %u times: %d\n",
+			   priv->reset_retries, ret);
+	priv->reset_retries = 0;
+	phy_start(netdev->phydev);
+
+unlock:
+	rtnl_unlock();
 }
 
 static int lan865x_probe(struct spi_device *spi)
 {
 	struct net_device *netdev;
 	struct lan865x_priv *priv;
+	u32 bus_weight;
 	int ret;
 
 	netdev = alloc_etherdev(sizeof(struct lan865x_priv));
@@ -308,6 +886,10 @@ static int lan865x_probe(struct spi_device *spi)
 	priv->spi = spi;
 	spi_set_drvdata(spi, priv);
 	INIT_WORK(&priv->multicast_work, lan865x_multicast_work_handler);
+	INIT_DELAYED_WORK(&priv->reset_work, lan865x_reset_work_handler);
+	INIT_DELAYED_WORK(&priv->stats_work, lan865x_stats_work_handler);
+	mutex_init(&priv->stats_lock);
+	priv->stats_updated = jiffies - LAN865X_STATS_MIN_AGE;
 
 	priv->tc6 = oa_tc6_init(spi, netdev);
 	if (!priv->tc6) {
@@ -315,6 +897,19 @@ static int lan865x_probe(struct spi_device *spi)
 		goto free_netdev;
 	}
 
+	oa_tc6_set_volatile_reg(priv->tc6, lan865x_volatile_reg);
+
+	/* Share of the SPI bus if it is shared with other MAC-PHYs */
+	if (!device_property_read_u32(&spi->dev, "microchip,spi-bus-weight",
+				      &bus_weight)) {
+		ret = oa_tc6_set_bus_weight(priv->tc6, bus_weight);
+		if (ret) {
+			dev_err(&spi->dev, "Invalid SPI bus weight %u\n",
+				bus_weight);
+			goto oa_tc6_exit;
+		}
+	}
+
 	ret = lan865x_configure_fixup(priv);
 	if (ret) {
 		dev_err(&spi->dev, "Failed to configure fixup: %d\n", ret);
@@ -349,19 +944,30 @@ static int lan865x_probe(struct spi_device *spi)
 		goto oa_tc6_exit;
 	}
 
+	ret = lan865x_ptp_init(&priv->ptp, priv->tc6, &spi->dev);
+	if (ret) {
+		dev_err(&spi->dev, "Failed to register PTP clock: %d\n", ret);
+		goto oa_tc6_exit;
+	}
+
 	netdev->if_port = IF_PORT_10BASET;
 	netdev->irq = spi->irq;
+	netdev->hw_features |= NETIF_F_SG;
+	netdev->features |= NETIF_F_SG;
 	netdev->netdev_ops = &lan865x_netdev_ops;
+	netdev->watchdog_timeo = LAN865X_TX_TIMEOUT;
 	netdev->ethtool_ops = &lan865x_ethtool_ops;
 
 	ret = register_netdev(netdev);
 	if (ret) {
 		dev_err(&spi->dev, "Register netdev failed (ret = %d)", ret);
-		goto oa_tc6_exit;
+		goto ptp_exit;
 	}
 
 	return 0;
 
+ptp_exit:
+	lan865x_ptp_exit(&priv->ptp);
 oa_tc6_exit:
 	oa_tc6_exit(priv->tc6);
 free_netdev:
@@ -375,6 +981,11 @@ static void lan865x_remove(struct spi_device *spi)
 
 	cancel_work_sync(&priv->multicast_work);
 	unregister_netdev(priv->netdev);
+	/* The watchdog is stopped and a retry finds the interface down, so the
+	 * reset work isn't scheduled again.
+	 */
+	cancel_delayed_work_sync(&priv->reset_work);
+	lan865x_ptp_exit(&priv->ptp);
 	oa_tc6_exit(priv->tc6);
 	free_netdev(priv->netdev);
 }
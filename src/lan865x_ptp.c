@@ -0,0 +1,543 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Microchip's LAN865x 10BASE-T1S MAC-PHY PTP hardware clock
+ *
+ * The wall clock is the time stamping unit (TSU) of the MAC, a 48 bit
+ * seconds and 30 bit nanoseconds counter which is advanced by the timer
+ * increment on every 25 MHz clock cycle.
+ *
+ * The timer is captured on the rising edge of the strobe input, which is
+ * exposed as external timestamp channel 0, and a pulse per second is output
+ * at every rollover of the seconds, which is periodic output channel 0.
+ */
+
+#include <linux/bitfield.h>
+#include <linux/device.h>
+#include <linux/net_tstamp.h>
+#include "lan865x_ptp.h"
+
+/* OPEN Alliance Status Register #1 and Interrupt Mask Register #1 */
+#define STATUS1_SEV			BIT(28) /* Synchronization Event */
+#define OA_TC6_REG_INT_MASK1		0x000D
+#define INT_MASK1_SEV_MASK		BIT(28)
+
+/* Timer Increment Sub-nanoseconds Register */
+#define LAN865X_REG_MAC_TISUBN		0x0001006F
+#define MAC_TISUBN_LSB			GENMASK(31, 24) /* Sub-ns bits 7:0 */
+#define MAC_TISUBN_MSB			GENMASK(15, 0) /* Sub-ns bits 23:8 */
+
+#define LAN865X_REG_MAC_TSH		0x00010070 /* Timer Seconds High Reg */
+#define MAC_TSH_SECONDS			GENMASK(15, 0)
+#define LAN865X_REG_MAC_TSSH		0x00010071 /* Strobe Seconds High Reg */
+#define LAN865X_REG_MAC_TSSL		0x00010072 /* Strobe Seconds Low Reg */
+#define LAN865X_REG_MAC_TSSN		0x00010073 /* Strobe Nanoseconds Reg */
+#define LAN865X_REG_MAC_TSL		0x00010074 /* Timer Seconds Low Reg */
+#define LAN865X_REG_MAC_TN		0x00010075 /* Timer Nanoseconds Reg */
+#define MAC_TN_NANOSECONDS		GENMASK(29, 0)
+
+/* Timer Adjust Register */
+#define LAN865X_REG_MAC_TA		0x00010076
+#define MAC_TA_SUBTRACT			BIT(31)
+#define MAC_TA_NANOSECONDS		GENMASK(29, 0)
+
+/* Timer Increment Register */
+#define LAN865X_REG_MAC_TI		0x00010077
+#define MAC_TI_NANOSECONDS		GENMASK(7, 0)
+
+/* Pulse Per Second Control Register */
+#define LAN865X_REG_PPSCTL		0x000A0239
+#define PPSCTL_PPSEN			BIT(0)
+
+/* TSSH up to TSSN, read by the SPI data transfer loop on a strobe event */
+#define LAN865X_PTP_STROBE_REGS		(LAN865X_REG_MAC_TSSN - \
+					 LAN865X_REG_MAC_TSSH + 1)
+
+/* TSH up to TN, read in one control transfer */
+#define LAN865X_PTP_TIME_REGS		(LAN865X_REG_MAC_TN - \
+					 LAN865X_REG_MAC_TSH + 1)
+#define LAN865X_PTP_TSH			0
+#define LAN865X_PTP_TSL			(LAN865X_REG_MAC_TSL - \
+					 LAN865X_REG_MAC_TSH)
+#define LAN865X_PTP_TN			(LAN865X_REG_MAC_TN - \
+					 LAN865X_REG_MAC_TSH)
+
+/* 40 ns per cycle of the 25 MHz clock, in 2^-24 ns */
+#define LAN865X_PTP_SUBNS_BITS		24
+#define LAN865X_PTP_NOMINAL_INCR	(40 << LAN865X_PTP_SUBNS_BITS)
+#define LAN865X_PTP_MAX_ADJ		1000000 /* ppb */
+
+/* The registers are read in the order of their addresses, so seconds read
+ * before a wrap of the nanoseconds may come with nanoseconds read after it.
+ * A burst is done well within this window.
+ */
+#define LAN865X_PTP_WRAP_WINDOW_NS	(100 * NSEC_PER_USEC)
+
+/* The offset to the system clock the launch times are scheduled with is
+ * measured this often, which keeps the drift in between in the order of a
+ * microsecond for clocks within 10 ppm.
+ */
+#define LAN865X_PTP_OFFSET_PERIOD	(HZ / 10)
+
+static int lan865x_ptp_read_seconds(struct lan865x_ptp *ptp, u64 *seconds)
+{
+	u32 regs[LAN865X_PTP_TSL + 1];
+	int ret;
+
+	ret = oa_tc6_read_registers(ptp->tc6, LAN865X_REG_MAC_TSH, regs,
+				    ARRAY_SIZE(regs));
+	if (ret)
+		return ret;
+
+	*seconds = (u64)FIELD_GET(MAC_TSH_SECONDS, regs[LAN865X_PTP_TSH]) << 32 |
+		   regs[LAN865X_PTP_TSL];
+
+	return 0;
+}
+
+static int lan865x_ptp_gettime(struct lan865x_ptp *ptp, struct timespec64 *ts,
+			       struct ptp_system_timestamp *sts)
+{
+	u32 regs[LAN865X_PTP_TIME_REGS];
+	u64 seconds;
+	int ret;
+
+	/* The seconds and the nanoseconds come in one SPI transfer, the system
+	 * timestamps are taken around the bytes that latch the nanoseconds.
+	 */
+	ret = oa_tc6_read_registers_sts(ptp->tc6, LAN865X_REG_MAC_TSH, regs,
+					ARRAY_SIZE(regs), LAN865X_PTP_TN, sts);
+	if (ret)
+		return ret;
+
+	seconds = (u64)FIELD_GET(MAC_TSH_SECONDS, regs[LAN865X_PTP_TSH]) << 32 |
+		  regs[LAN865X_PTP_TSL];
+	ts->tv_nsec = FIELD_GET(MAC_TN_NANOSECONDS, regs[LAN865X_PTP_TN]);
+
+	/* The nanoseconds may have wrapped after the seconds were read. The
+	 * seconds read again belong to the nanoseconds read before.
+	 */
+	if (ts->tv_nsec < LAN865X_PTP_WRAP_WINDOW_NS) {
+		ret = lan865x_ptp_read_seconds(ptp, &seconds);
+		if (ret)
+			return ret;
+	}
+
+	ts->tv_sec = seconds;
+
+	return 0;
+}
+
+static int lan865x_ptp_settime(struct lan865x_ptp *ptp,
+			       const struct timespec64 *ts)
+{
+	struct oa_tc6_txn txn;
+
+	oa_tc6_txn_init(&txn);
+	/* Cleared first, so the seconds don't get incremented meanwhile */
+	oa_tc6_txn_write(&txn, LAN865X_REG_MAC_TN, 0);
+	oa_tc6_txn_write(&txn, LAN865X_REG_MAC_TSH,
+			 FIELD_PREP(MAC_TSH_SECONDS, ts->tv_sec >> 32));
+	oa_tc6_txn_write(&txn, LAN865X_REG_MAC_TSL, lower_32_bits(ts->tv_sec));
+	oa_tc6_txn_write(&txn, LAN865X_REG_MAC_TN, ts->tv_nsec);
+
+	return oa_tc6_txn_execute(ptp->tc6, &txn, OA_TC6_CTRL_PRIO_HIGH);
+}
+
+static int lan865x_ptp_write_incr(struct lan865x_ptp *ptp, u32 incr)
+{
+	u32 subns = incr & GENMASK(LAN865X_PTP_SUBNS_BITS - 1, 0);
+	struct oa_tc6_txn txn;
+
+	oa_tc6_txn_init(&txn);
+	oa_tc6_txn_write(&txn, LAN865X_REG_MAC_TISUBN,
+			 FIELD_PREP(MAC_TISUBN_LSB, subns) |
+			 FIELD_PREP(MAC_TISUBN_MSB, subns >> 8));
+	oa_tc6_txn_write(&txn, LAN865X_REG_MAC_TI,
+			 FIELD_PREP(MAC_TI_NANOSECONDS,
+				    incr >> LAN865X_PTP_SUBNS_BITS));
+
+	return oa_tc6_txn_execute(ptp->tc6, &txn, OA_TC6_CTRL_PRIO_HIGH);
+}
+
+/* Measures the offset of the clock to CLOCK_REALTIME for the launch time
+ * scheduling.
+ */
+static int lan865x_ptp_update_offset(struct lan865x_ptp *ptp)
+{
+	struct ptp_system_timestamp sts = {};
+	struct timespec64 ts;
+	s64 sys_ns;
+	int ret;
+
+	ret = lan865x_ptp_gettime(ptp, &ts, &sts);
+	if (ret)
+		return ret;
+
+	/* Not taken by an SPI controller driver without a transfer_one() */
+	if (!sts.pre_ts.tv_sec)
+		return -EOPNOTSUPP;
+
+	sys_ns = timespec64_to_ns(&sts.pre_ts);
+	sys_ns += (timespec64_to_ns(&sts.post_ts) - sys_ns) >> 1;
+	oa_tc6_set_phc_offset(ptp->tc6, timespec64_to_ns(&ts) - sys_ns);
+
+	return 0;
+}
+
+/* The offset is measured again right away after the clock was stepped */
+static void lan865x_ptp_clock_stepped(struct lan865x_ptp *ptp)
+{
+	if (ptp->launch_time)
+		ptp_schedule_worker(ptp->clock, 0);
+}
+
+static int lan865x_ptp_gettimex64(struct ptp_clock_info *info,
+				  struct timespec64 *ts,
+				  struct ptp_system_timestamp *sts)
+{
+	struct lan865x_ptp *ptp = container_of(info, struct lan865x_ptp, info);
+	int ret;
+
+	mutex_lock(&ptp->lock);
+	ret = lan865x_ptp_gettime(ptp, ts, sts);
+	mutex_unlock(&ptp->lock);
+
+	return ret;
+}
+
+static int lan865x_ptp_settime64(struct ptp_clock_info *info,
+				 const struct timespec64 *ts)
+{
+	struct lan865x_ptp *ptp = container_of(info, struct lan865x_ptp, info);
+	int ret;
+
+	mutex_lock(&ptp->lock);
+	ret = lan865x_ptp_settime(ptp, ts);
+	if (!ret)
+		lan865x_ptp_clock_stepped(ptp);
+	mutex_unlock(&ptp->lock);
+
+	return ret;
+}
+
+static int lan865x_ptp_adjtime(struct ptp_clock_info *info, s64 delta)
+{
+	struct lan865x_ptp *ptp = container_of(info, struct lan865x_ptp, info);
+	struct timespec64 ts;
+	u32 regval;
+	int ret;
+
+	mutex_lock(&ptp->lock);
+
+	/* The timer adjust register only takes less than a second */
+	if (delta <= -NSEC_PER_SEC || delta >= NSEC_PER_SEC) {
+		ret = lan865x_ptp_gettime(ptp, &ts, NULL);
+		if (!ret) {
+			ts = timespec64_add(ts, ns_to_timespec64(delta));
+			ret = lan865x_ptp_settime(ptp, &ts);
+		}
+		goto unlock;
+	}
+
+	regval = FIELD_PREP(MAC_TA_NANOSECONDS, abs(delta));
+	if (delta < 0)
+		regval |= MAC_TA_SUBTRACT;
+
+	ret = oa_tc6_write_register(ptp->tc6, LAN865X_REG_MAC_TA, regval);
+
+unlock:
+	if (!ret)
+		lan865x_ptp_clock_stepped(ptp);
+	mutex_unlock(&ptp->lock);
+
+	return ret;
+}
+
+static int lan865x_ptp_adjfine(struct ptp_clock_info *info, long scaled_ppm)
+{
+	struct lan865x_ptp *ptp = container_of(info, struct lan865x_ptp, info);
+	u32 incr;
+	int ret;
+
+	incr = adjust_by_scaled_ppm(LAN865X_PTP_NOMINAL_INCR, scaled_ppm);
+
+	mutex_lock(&ptp->lock);
+	ret = lan865x_ptp_write_incr(ptp, incr);
+	if (!ret)
+		ptp->incr = incr;
+	mutex_unlock(&ptp->lock);
+
+	return ret;
+}
+
+static void lan865x_ptp_strobe_event(struct oa_tc6_event_capture *capture,
+				     u32 status1, u32 value[])
+{
+	struct lan865x_ptp *ptp = container_of(capture, struct lan865x_ptp,
+					       strobe);
+	struct ptp_clock_event event = {
+		.type = PTP_CLOCK_EXTTS,
+		.index = 0,
+	};
+	u64 seconds;
+
+	if (!READ_ONCE(ptp->extts_enabled))
+		return;
+
+	seconds = (u64)FIELD_GET(MAC_TSH_SECONDS, value[0]) << 32 | value[1];
+	event.timestamp = seconds * NSEC_PER_SEC +
+			  FIELD_GET(MAC_TN_NANOSECONDS, value[2]);
+	ptp_clock_event(ptp->clock, &event);
+}
+
+static int lan865x_ptp_set_extts(struct lan865x_ptp *ptp, bool enable)
+{
+	int ret;
+
+	ret = oa_tc6_update_register(ptp->tc6, OA_TC6_REG_INT_MASK1,
+				     INT_MASK1_SEV_MASK,
+				     enable ? 0 : INT_MASK1_SEV_MASK);
+	if (ret)
+		return ret;
+
+	WRITE_ONCE(ptp->extts_enabled, enable);
+
+	return 0;
+}
+
+static int lan865x_ptp_set_pps(struct lan865x_ptp *ptp, bool enable)
+{
+	int ret;
+
+	ret = oa_tc6_update_register(ptp->tc6, LAN865X_REG_PPSCTL,
+				     PPSCTL_PPSEN, enable ? PPSCTL_PPSEN : 0);
+	if (ret)
+		return ret;
+
+	ptp->pps_enabled = enable;
+
+	return 0;
+}
+
+static int lan865x_ptp_enable_extts(struct lan865x_ptp *ptp,
+				    struct ptp_extts_request *extts, int on)
+{
+	if (extts->index)
+		return -EINVAL;
+
+	if (extts->flags & ~(PTP_ENABLE_FEATURE | PTP_RISING_EDGE |
+			     PTP_FALLING_EDGE | PTP_STRICT_FLAGS))
+		return -EOPNOTSUPP;
+
+	/* The strobe is captured on the rising edge only */
+	if ((extts->flags & PTP_STRICT_FLAGS) &&
+	    (extts->flags & PTP_ENABLE_FEATURE) &&
+	    (extts->flags & PTP_EXTTS_EDGES) != PTP_RISING_EDGE)
+		return -EOPNOTSUPP;
+
+	return lan865x_ptp_set_extts(ptp, on);
+}
+
+static int lan865x_ptp_enable_perout(struct lan865x_ptp *ptp,
+				     struct ptp_perout_request *perout, int on)
+{
+	if (perout->index)
+		return -EINVAL;
+
+	if (perout->flags)
+		return -EOPNOTSUPP;
+
+	if (!on)
+		return lan865x_ptp_set_pps(ptp, false);
+
+	/* The pulses come at the rollovers of the seconds */
+	if (perout->period.sec * NSEC_PER_SEC + perout->period.nsec !=
+	    NSEC_PER_SEC || perout->start.nsec)
+		return -EOPNOTSUPP;
+
+	return lan865x_ptp_set_pps(ptp, true);
+}
+
+static int lan865x_ptp_enable(struct ptp_clock_info *info,
+			      struct ptp_clock_request *rq, int on)
+{
+	struct lan865x_ptp *ptp = container_of(info, struct lan865x_ptp, info);
+	int ret;
+
+	mutex_lock(&ptp->lock);
+	switch (rq->type) {
+	case PTP_CLK_REQ_EXTTS:
+		ret = lan865x_ptp_enable_extts(ptp, &rq->extts, on);
+		break;
+	case PTP_CLK_REQ_PEROUT:
+		ret = lan865x_ptp_enable_perout(ptp, &rq->perout, on);
+		break;
+	default:
+		ret = -EOPNOTSUPP;
+		break;
+	}
+	mutex_unlock(&ptp->lock);
+
+	return ret;
+}
+
+static long lan865x_ptp_do_aux_work(struct ptp_clock_info *info)
+{
+	struct lan865x_ptp *ptp = container_of(info, struct lan865x_ptp, info);
+	long delay = -1;
+
+	mutex_lock(&ptp->lock);
+	if (ptp->launch_time) {
+		/* A failed measurement keeps the last offset */
+		lan865x_ptp_update_offset(ptp);
+		delay = LAN865X_PTP_OFFSET_PERIOD;
+	}
+	mutex_unlock(&ptp->lock);
+
+	return delay;
+}
+
+static const struct ptp_clock_info lan865x_ptp_clock_info = {
+	.owner		= THIS_MODULE,
+	.name		= "lan865x",
+	.max_adj	= LAN865X_PTP_MAX_ADJ,
+	.gettimex64	= lan865x_ptp_gettimex64,
+	.settime64	= lan865x_ptp_settime64,
+	.adjtime	= lan865x_ptp_adjtime,
+	.adjfine	= lan865x_ptp_adjfine,
+	.enable		= lan865x_ptp_enable,
+	.do_aux_work	= lan865x_ptp_do_aux_work,
+	.n_ext_ts	= 1,
+	.n_per_out	= 1,
+};
+
+/**
+ * lan865x_ptp_init - register the PTP hardware clock of a MAC-PHY.
+ * @ptp: PTP clock context.
+ * @tc6: oa_tc6 struct of the MAC-PHY.
+ * @dev: parent device of the clock.
+ *
+ * The clock keeps running at the nominal rate without it, so a kernel
+ * without PTP clock support is not an error.
+ *
+ * Returns 0 on success otherwise failed.
+ */
+int lan865x_ptp_init(struct lan865x_ptp *ptp, struct oa_tc6 *tc6,
+		     struct device *dev)
+{
+	struct ptp_clock *clock;
+
+	mutex_init(&ptp->lock);
+	ptp->tc6 = tc6;
+	ptp->incr = LAN865X_PTP_NOMINAL_INCR;
+	ptp->info = lan865x_ptp_clock_info;
+
+	clock = ptp_clock_register(&ptp->info, dev);
+	if (IS_ERR(clock))
+		return PTR_ERR(clock);
+
+	ptp->clock = clock;
+	if (!clock)
+		return 0;
+
+	/* The strobe timestamp is read along with the interrupt status */
+	ptp->strobe.status1 = STATUS1_SEV;
+	ptp->strobe.address = LAN865X_REG_MAC_TSSH;
+	ptp->strobe.length = LAN865X_PTP_STROBE_REGS;
+	ptp->strobe.handler = lan865x_ptp_strobe_event;
+
+	return oa_tc6_set_event_capture(tc6, &ptp->strobe);
+}
+
+/**
+ * lan865x_ptp_exit - unregister the PTP hardware clock of a MAC-PHY.
+ * @ptp: PTP clock context.
+ */
+void lan865x_ptp_exit(struct lan865x_ptp *ptp)
+{
+	/* The strobe handler reports to the clock, so it is stopped first */
+	oa_tc6_set_event_capture(ptp->tc6, NULL);
+	if (ptp->clock)
+		ptp_clock_unregister(ptp->clock);
+	mutex_destroy(&ptp->lock);
+}
+
+/**
+ * lan865x_ptp_restore - restore the clock rate and the enabled external
+ * timestamp and periodic output channels after a MAC-PHY reset.
+ * @ptp: PTP clock context.
+ *
+ * The time itself is lost on a reset and is set again by the servo.
+ *
+ * Returns 0 on success otherwise failed.
+ */
+int lan865x_ptp_restore(struct lan865x_ptp *ptp)
+{
+	int ret;
+
+	mutex_lock(&ptp->lock);
+	ret = lan865x_ptp_write_incr(ptp, ptp->incr);
+	if (!ret && ptp->extts_enabled)
+		ret = lan865x_ptp_set_extts(ptp, true);
+	if (!ret && ptp->pps_enabled)
+		ret = lan865x_ptp_set_pps(ptp, true);
+	mutex_unlock(&ptp->lock);
+
+	return ret;
+}
+
+/**
+ * lan865x_ptp_set_launch_time - start or stop measuring the offset of the
+ * clock to the system clock for the launch time scheduling.
+ * @ptp: PTP clock context.
+ * @enable: true if the tx frames are held until their launch time.
+ *
+ * The launch times are in PHC time, but the SPI data transfer loop can't read
+ * the clock for every frame. It derives the PHC time from the system clock
+ * with the offset measured here periodically.
+ *
+ * Returns 0 on success otherwise failed.
+ */
+int lan865x_ptp_set_launch_time(struct lan865x_ptp *ptp, bool enable)
+{
+	int ret = 0;
+
+	if (!ptp->clock)
+		return enable ? -EOPNOTSUPP : 0;
+
+	mutex_lock(&ptp->lock);
+	if (enable)
+		ret = lan865x_ptp_update_offset(ptp);
+	if (!ret) {
+		ptp->launch_time = enable;
+		if (enable)
+			ptp_schedule_worker(ptp->clock,
+					    LAN865X_PTP_OFFSET_PERIOD);
+	}
+	mutex_unlock(&ptp->lock);
+
+	return ret;
+}
+
+/**
+ * lan865x_ptp_get_ts_info - report the time stamping capabilities.
+ * @ptp: PTP clock context.
+ * @info: time stamping capabilities to be filled in.
+ *
+ * Returns 0.
+ */
+int lan865x_ptp_get_ts_info(struct lan865x_ptp *ptp,
+			    struct lan865x_ts_info *info)
+{
+	info->so_timestamping = SOF_TIMESTAMPING_TX_SOFTWARE |
+				SOF_TIMESTAMPING_RX_SOFTWARE |
+				SOF_TIMESTAMPING_SOFTWARE |
+				SOF_TIMESTAMPING_TX_HARDWARE |
+				SOF_TIMESTAMPING_RX_HARDWARE |
+				SOF_TIMESTAMPING_RAW_HARDWARE;
+	info->phc_index = ptp->clock ? ptp_clock_index(ptp->clock) : -1;
+	info->tx_types = BIT(HWTSTAMP_TX_OFF) | BIT(HWTSTAMP_TX_ON);
+	info->rx_filters = BIT(HWTSTAMP_FILTER_NONE) | BIT(HWTSTAMP_FILTER_ALL);
+
+	return 0;
+}
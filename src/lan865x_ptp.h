@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Microchip's LAN865x 10BASE-T1S MAC-PHY PTP hardware clock
+ */
+
+#ifndef _LAN865X_PTP_H
+#define _LAN865X_PTP_H
+
+#include <linux/ethtool.h>
+#include <linux/mutex.h>
+#include <linux/ptp_clock_kernel.h>
+#include <linux/version.h>
+#include "oa_tc6.h"
+
+/* The ethtool timestamping info got its kernel-only type in Linux 6.11 */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 11, 0)
+#define lan865x_ts_info kernel_ethtool_ts_info
+#else
+#define lan865x_ts_info ethtool_ts_info
+#endif
+
+struct lan865x_ptp {
+	struct ptp_clock_info info;
+	struct ptp_clock *clock;
+	struct oa_tc6 *tc6;
+	struct mutex lock; /* Serializes the clock and channel updates */
+	u32 incr; /* Timer increment in 2^-24 ns, replayed after a reset */
+	struct oa_tc6_event_capture strobe; /* External timestamp capture */
+	bool extts_enabled;
+	bool pps_enabled;
+	bool launch_time; /* The offset to the system clock is measured */
+};
+
+int lan865x_ptp_init(struct lan865x_ptp *ptp, struct oa_tc6 *tc6,
+		     struct device *dev);
+void lan865x_ptp_exit(struct lan865x_ptp *ptp);
+int lan865x_ptp_restore(struct lan865x_ptp *ptp);
+int lan865x_ptp_set_launch_time(struct lan865x_ptp *ptp, bool enable);
+int lan865x_ptp_get_ts_info(struct lan865x_ptp *ptp,
+			    struct lan865x_ts_info *info);
+
+#endif /* _LAN865X_PTP_H */
@@ -38,6 +38,12 @@
 #define LAN86XX_COL_DET_MASK 0x8000
 #define LAN86XX_REG_COL_DET_CTRL0 0x0087
 
+/* PLCA settings, replayed by config_init after a reset of the PHY */
+struct lan86xx_priv {
+	struct phy_plca_cfg plca_cfg;
+	bool plca_cfg_valid;
+};
+
 /* The arrays below are pulled from the following table from AN1699
  * Access MMD Address Value Mask
  * RMW 0x1F 0x00D0 0x0002 0x0E03
@@ -204,6 +210,53 @@ static int lan865x_setup_cfgparam(struct phy_device *phydev)
 	return lan865x_write_cfg_params(phydev, cfg_results);
 }
 
+static int lan86xx_apply_plca_cfg(struct phy_device *phydev,
+				  const struct phy_plca_cfg *plca_cfg)
+{
+	int ret;
+
+	ret = genphy_c45_plca_set_cfg(phydev, plca_cfg);
+	if(ret)
+		return ret;
+
+	if (plca_cfg->enabled)
+		return phy_modify_mmd(phydev, MDIO_MMD_VEND2, LAN86XX_REG_COL_DET_CTRL0,
+				      LAN86XX_COL_DET_MASK, LAN86XX_DISABLE_COL_DET);
+
+	return phy_modify_mmd(phydev, MDIO_MMD_VEND2, LAN86XX_REG_COL_DET_CTRL0,
+			      LAN86XX_COL_DET_MASK, LAN86XX_ENABLE_COL_DET);
+}
+
+static int lan86xx_c45_plca_set_cfg(struct phy_device *phydev,
+				    const struct phy_plca_cfg *plca_cfg)
+{
+	struct lan86xx_priv *priv = phydev->priv;
+	int ret;
+
+	ret = lan86xx_apply_plca_cfg(phydev, plca_cfg);
+	if (ret)
+		return ret;
+
+	/* Remember the resulting settings, plca_cfg may change only some */
+	ret = genphy_c45_plca_get_cfg(phydev, &priv->plca_cfg);
+	if (ret)
+		return ret;
+
+	priv->plca_cfg_valid = true;
+
+	return 0;
+}
+
+static int lan86xx_restore_plca_cfg(struct phy_device *phydev)
+{
+	struct lan86xx_priv *priv = phydev->priv;
+
+	if (!priv->plca_cfg_valid)
+		return 0;
+
+	return lan86xx_apply_plca_cfg(phydev, &priv->plca_cfg);
+}
+
 static int lan865x_revb_config_init(struct phy_device *phydev)
 {
 	int ret;
@@ -221,7 +274,11 @@ static int lan865x_revb_config_init(struct phy_device *phydev)
 	/* Function to calculate and write the configuration parameters in the
 	 * 0x0084, 0x008A, 0x00AD, 0x00AE and 0x00AF registers (from AN1760)
 	 */
-	return lan865x_setup_cfgparam(phydev);
+	ret = lan865x_setup_cfgparam(phydev);
+	if (ret)
+		return ret;
+
+	return lan86xx_restore_plca_cfg(phydev);
 }
 
 static int lan867x_reset_complete_status(struct phy_device *phydev)
@@ -281,11 +338,15 @@ static int lan867x_revc_config_init(struct phy_device *phydev)
 	ret = phy_read(phydev, LAN867X_REG_STRAP0);
 	if (ret < 0)
 		return ret;
-	if (FIELD_GET(LAN867X_IF_TYPE, ret) == LAN867X_RMII_IF_TYPE)
-		return phy_write_mmd(phydev, MDIO_MMD_VEND2,
-				     LAN867X_REG_RMII_FIXUP,
-				     LAN867X_RMII_FIXUP_VALUE);
-	return 0;
+	if (FIELD_GET(LAN867X_IF_TYPE, ret) == LAN867X_RMII_IF_TYPE) {
+		ret = phy_write_mmd(phydev, MDIO_MMD_VEND2,
+				    LAN867X_REG_RMII_FIXUP,
+				    LAN867X_RMII_FIXUP_VALUE);
+		if (ret)
+			return ret;
+	}
+
+	return lan86xx_restore_plca_cfg(phydev);
 }
 
 static int lan867x_revb1_config_init(struct phy_device *phydev)
@@ -311,24 +372,20 @@ static int lan867x_revb1_config_init(struct phy_device *phydev)
 			return err;
 	}
 
-	return 0;
+	return lan86xx_restore_plca_cfg(phydev);
 }
 
-static int lan86xx_c45_plca_set_cfg(struct phy_device *phydev,
-				    const struct phy_plca_cfg *plca_cfg)
+static int lan86xx_probe(struct phy_device *phydev)
 {
-	int ret;
+	struct lan86xx_priv *priv;
 
-	ret = genphy_c45_plca_set_cfg(phydev, plca_cfg);
-	if(ret)
-		return ret;
+	priv = devm_kzalloc(&phydev->mdio.dev, sizeof(*priv), GFP_KERNEL);
+	if (!priv)
+		return -ENOMEM;
 
-	if (plca_cfg->enabled)
-		return phy_modify_mmd(phydev, MDIO_MMD_VEND2, LAN86XX_REG_COL_DET_CTRL0,
-				      LAN86XX_COL_DET_MASK, LAN86XX_DISABLE_COL_DET);
+	phydev->priv = priv;
 
-	return phy_modify_mmd(phydev, MDIO_MMD_VEND2, LAN86XX_REG_COL_DET_CTRL0,
-			      LAN86XX_COL_DET_MASK, LAN86XX_ENABLE_COL_DET);
+	return 0;
 }
 
 static int lan86xx_read_status(struct phy_device *phydev)
@@ -351,6 +408,7 @@ static struct phy_driver microchip_t1s_driver[] = {
 		PHY_ID_MATCH_EXACT(PHY_ID_LAN867X_REVB1),
 		.name               = "LAN867X Rev.B1",
 		.features           = PHY_BASIC_T1S_P2MP_FEATURES,
+		.probe              = lan86xx_probe,
 		.config_init        = lan867x_revb1_config_init,
 		.read_status        = lan86xx_read_status,
 		.get_plca_cfg	    = genphy_c45_plca_get_cfg,
@@ -361,6 +419,7 @@ static struct phy_driver microchip_t1s_driver[] = {
 		PHY_ID_MATCH_EXACT(PHY_ID_LAN867X_REVC1),
 		.name               = "LAN867X Rev.C1",
 		.features           = PHY_BASIC_T1S_P2MP_FEATURES,
+		.probe              = lan86xx_probe,
 		.config_init        = lan867x_revc_config_init,
 		.read_status        = lan86xx_read_status,
 		.get_plca_cfg	    = genphy_c45_plca_get_cfg,
@@ -371,6 +430,7 @@ static struct phy_driver microchip_t1s_driver[] = {
 		PHY_ID_MATCH_EXACT(PHY_ID_LAN867X_REVC2),
 		.name               = "LAN867X Rev.C2",
 		.features           = PHY_BASIC_T1S_P2MP_FEATURES,
+		.probe              = lan86xx_probe,
 		.config_init        = lan867x_revc_config_init,
 		.read_status        = lan86xx_read_status,
 		.get_plca_cfg	    = genphy_c45_plca_get_cfg,
@@ -381,6 +441,7 @@ static struct phy_driver microchip_t1s_driver[] = {
 		PHY_ID_MATCH_EXACT(PHY_ID_LAN865X_REVB),
 		.name               = "LAN865X Rev.B0/B1 Internal Phy",
 		.features           = PHY_BASIC_T1S_P2MP_FEATURES,
+		.probe              = lan86xx_probe,
 		.config_init        = lan865x_revb_config_init,
 		.read_status        = lan86xx_read_status,
 		.get_plca_cfg	    = genphy_c45_plca_get_cfg,
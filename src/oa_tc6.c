@@ -6,12 +6,25 @@
  */
 
 #include <linux/bitfield.h>
+#include <linux/hashtable.h>
+#include <linux/hrtimer.h>
 #include <linux/iopoll.h>
 #include <linux/mdio.h>
+#include <linux/net_tstamp.h>
 #include <linux/phy.h>
+#include <linux/u64_stats_sync.h>
+#include <linux/version.h>
+#include <net/page_pool/helpers.h>
 #include "oa_tc6.h"
+#include "oa_tc6_framing.h"
+
+#define CREATE_TRACE_POINTS
+#include "oa_tc6_trace.h"
 
 /* OPEN Alliance TC6 registers */
+/* PHY Identification Register */
+#define OA_TC6_REG_PHYID			0x0001
+
 /* Standard Capabilities Register */
 #define OA_TC6_REG_STDCAP			0x0002
 #define STDCAP_DIRECT_PHY_REG_ACCESS		BIT(8)
@@ -23,15 +36,21 @@
 /* Configuration Register #0 */
 #define OA_TC6_REG_CONFIG0			0x0004
 #define CONFIG0_SYNC				BIT(15)
+#define CONFIG0_FTSE				BIT(7)	/* Frame Timestamp Enable */
+#define CONFIG0_FTSS				BIT(6)	/* 64 bit timestamps */
 
 /* Status Register #0 */
 #define OA_TC6_REG_STATUS0			0x0008
+#define STATUS0_TTSCAA				BIT(8)	/* Tx Timestamp A */
 #define STATUS0_RESETC				BIT(6)	/* Reset Complete */
 #define STATUS0_HEADER_ERROR			BIT(5)
 #define STATUS0_LOSS_OF_FRAME_ERROR		BIT(4)
 #define STATUS0_RX_BUFFER_OVERFLOW_ERROR	BIT(3)
 #define STATUS0_TX_PROTOCOL_ERROR		BIT(0)
 
+/* Status Register #1 */
+#define OA_TC6_REG_STATUS1			0x0009
+
 /* Buffer Status Register */
 #define OA_TC6_REG_BUFFER_STATUS		0x000B
 #define BUFFER_STATUS_TX_CREDITS_AVAILABLE	GENMASK(15, 8)
@@ -39,11 +58,18 @@
 
 /* Interrupt Mask Register #0 */
 #define OA_TC6_REG_INT_MASK0			0x000C
+#define INT_MASK0_TTSCAA_MASK			BIT(8)
 #define INT_MASK0_HEADER_ERR_MASK		BIT(5)
 #define INT_MASK0_LOSS_OF_FRAME_ERR_MASK	BIT(4)
 #define INT_MASK0_RX_BUFFER_OVERFLOW_ERR_MASK	BIT(3)
 #define INT_MASK0_TX_PROTOCOL_ERR_MASK		BIT(0)
 
+/* Interrupt Mask Register #1 */
+#define OA_TC6_REG_INT_MASK1			0x000D
+
+/* Transmit Timestamp Capture A Registers, seconds and nanoseconds */
+#define OA_TC6_REG_TTSCAH			0x0010
+
 /* PHY Clause 22 and 29 registers base address and mask */
 #define OA_TC6_PHY_STD_REG_ADDR_BASE		0xFF00
 #define OA_TC6_PHY_STD_REG_ADDR_MASK		0x3F
@@ -56,27 +82,6 @@
 #define OA_TC6_CTRL_HEADER_LENGTH		GENMASK(7, 1)
 #define OA_TC6_CTRL_HEADER_PARITY		BIT(0)
 
-/* Data header */
-#define OA_TC6_DATA_HEADER_DATA_NOT_CTRL	BIT(31)
-#define OA_TC6_DATA_HEADER_DATA_VALID		BIT(21)
-#define OA_TC6_DATA_HEADER_START_VALID		BIT(20)
-#define OA_TC6_DATA_HEADER_START_WORD_OFFSET	GENMASK(19, 16)
-#define OA_TC6_DATA_HEADER_END_VALID		BIT(14)
-#define OA_TC6_DATA_HEADER_END_BYTE_OFFSET	GENMASK(13, 8)
-#define OA_TC6_DATA_HEADER_PARITY		BIT(0)
-
-/* Data footer */
-#define OA_TC6_DATA_FOOTER_EXTENDED_STS		BIT(31)
-#define OA_TC6_DATA_FOOTER_RXD_HEADER_BAD	BIT(30)
-#define OA_TC6_DATA_FOOTER_CONFIG_SYNC		BIT(29)
-#define OA_TC6_DATA_FOOTER_RX_CHUNKS_AVAILABLE	GENMASK(28, 24)
-#define OA_TC6_DATA_FOOTER_DATA_VALID		BIT(21)
-#define OA_TC6_DATA_FOOTER_START_VALID		BIT(20)
-#define OA_TC6_DATA_FOOTER_START_WORD_OFFSET	GENMASK(19, 16)
-#define OA_TC6_DATA_FOOTER_END_VALID		BIT(14)
-#define OA_TC6_DATA_FOOTER_END_BYTE_OFFSET	GENMASK(13, 8)
-#define OA_TC6_DATA_FOOTER_TX_CREDITS		GENMASK(5, 1)
-
 /* PHY – Clause 45 registers memory map selector (MMS) as per table 6 in the
  * OPEN Alliance specification.
  */
@@ -94,19 +99,141 @@
 						(OA_TC6_CTRL_MAX_REGISTERS *\
 						OA_TC6_CTRL_REG_VALUE_SIZE) +\
 						OA_TC6_CTRL_IGNORED_SIZE)
-#define OA_TC6_CHUNK_PAYLOAD_SIZE		64
-#define OA_TC6_DATA_HEADER_SIZE			4
-#define OA_TC6_CHUNK_SIZE			(OA_TC6_DATA_HEADER_SIZE +\
-						OA_TC6_CHUNK_PAYLOAD_SIZE)
+#define OA_TC6_CTRL_REG_SPI_SIZE		(OA_TC6_CTRL_HEADER_SIZE +\
+						OA_TC6_CTRL_REG_VALUE_SIZE +\
+						OA_TC6_CTRL_IGNORED_SIZE)
 #define OA_TC6_TX_SKB_QUEUE_SIZE		2
-#define OA_TC6_MAX_TX_CHUNKS			48
+#define OA_TC6_TX_RING_SIZE			64
+#define OA_TC6_RX_SKB_QUEUE_SIZE		256
+#define OA_TC6_NAPI_WEIGHT			NAPI_POLL_WEIGHT
+#define OA_TC6_RX_SKB_HDR_SIZE			128
+#define OA_TC6_RX_PAGE_POOL_SIZE		OA_TC6_RX_SKB_QUEUE_SIZE
 #define OA_TC6_SPI_DATA_BUF_SIZE		(OA_TC6_MAX_TX_CHUNKS *\
 						OA_TC6_CHUNK_SIZE)
+/* Header, payload, padding and packed frame payload transfer for every
+ * zero-copy tx chunk
+ */
+#define OA_TC6_MAX_SPI_DATA_XFERS		(OA_TC6_MAX_TX_CHUNKS * 4)
+#define OA_TC6_SPI_DATA_BUFS			2
+#define OA_TC6_REG_CACHE_BITS			5
+#define OA_TC6_CTRL_PRIOS			(OA_TC6_CTRL_PRIO_LOW + 1)
+#define OA_TC6_CTRL_LOW_PRIO_MAX_WAIT_NS	(10 * NSEC_PER_MSEC)
+#define OA_TC6_MAX_RECOVERY_ATTEMPTS		8
+#define OA_TC6_RX_TSTAMP_SIZE			8
+#define OA_TC6_TX_TSTAMP_TIMEOUT		HZ
+/* Initial estimate of the time from the release of a launch time frame into
+ * an SPI data transfer until the MAC-PHY transmits it, refined with the tx
+ * timestamps of these frames.
+ */
+#define OA_TC6_LAUNCH_LATENCY_NS		(100 * NSEC_PER_USEC)
+#define OA_TC6_LAUNCH_LATENCY_MAX_NS		(10 * NSEC_PER_MSEC)
+#define OA_TC6_LAUNCH_LATENCY_SHIFT		3 /* 1/8 weight per sample */
 #define STATUS0_RESETC_POLL_DELAY		1000
 #define STATUS0_RESETC_POLL_TIMEOUT		1000000
 
 #define MDIO_MMD_POWER_UNIT			13      /* PHY Power Unit */
 
+static bool framing_bench;
+module_param(framing_bench, bool, 0444);
+MODULE_PARM_DESC(framing_bench,
+		 "Benchmark the chunk framing on probe and pick the faster footer decoder");
+
+static bool threaded_irq;
+module_param(threaded_irq, bool, 0444);
+MODULE_PARM_DESC(threaded_irq,
+		 "Perform SPI transfers in the irq thread instead of a kthread");
+
+static unsigned int bus_chunk_cap = OA_TC6_MAX_TX_CHUNKS;
+module_param(bus_chunk_cap, uint, 0644);
+MODULE_PARM_DESC(bus_chunk_cap,
+		 "Maximum number of chunks in one SPI data transfer");
+
+static unsigned int ctrl_round_cap = 4;
+module_param(ctrl_round_cap, uint, 0644);
+MODULE_PARM_DESC(ctrl_round_cap,
+		 "Maximum number of normal and low priority control requests between two SPI data transfers");
+
+/* MAC-PHY capabilities beyond the mandatory ones of the specification */
+#define OA_TC6_CAP_TX_PACKING			BIT(0) /* Tx frame start mid chunk */
+
+/* Capabilities and quirks of the known MAC-PHY revisions */
+struct oa_tc6_revision {
+	u32 phyid;
+	u32 phyid_mask;
+	u32 caps;
+	const char *name;
+};
+
+static const struct oa_tc6_revision oa_tc6_revisions[] = {
+	{
+		.phyid = 0x0007C1B3,
+		.phyid_mask = 0xFFFFFFFF,
+		.caps = OA_TC6_CAP_TX_PACKING,
+		.name = "LAN8650/1 rev.B0/B1",
+	},
+};
+
+/* Shadow copy of a MAC-PHY register */
+struct oa_tc6_reg_cache_entry {
+	struct hlist_node node;
+	u32 address;
+	u32 value;
+};
+
+/* Buffers and messages of a control transfer. The messages are set up once
+ * and only the length of the generic one changes.
+ */
+struct oa_tc6_ctrl_buf {
+	struct spi_message msg;
+	struct spi_transfer xfer;
+	struct spi_message reg_msg; /* Single register access, optimized */
+	struct spi_transfer reg_xfer;
+	void *tx_buf;
+	void *rx_buf;
+};
+
+/* Buffers of a batched control transaction, one control command per op */
+struct oa_tc6_txn_buf {
+	struct spi_message msg;
+	struct spi_transfer xfers[OA_TC6_TXN_MAX_OPS];
+	void *tx_buf;
+	void *rx_buf;
+};
+
+/* Buffers and state of one SPI data transfer. Transfers are pipelined, so
+ * while one of them is on the bus the previous one is processed and the next
+ * one is prepared.
+ */
+struct oa_tc6_spi_data_buf {
+	struct spi_message *spi_msg; /* Message of the transfer on the bus */
+	struct spi_message msg; /* Copying transfer */
+	struct spi_transfer xfer;
+	struct spi_message chunk_msg; /* Single chunk transfer, optimized */
+	struct spi_transfer chunk_xfer;
+	struct spi_message zc_msg; /* Zero-copy transfer */
+	struct spi_transfer *xfers; /* Zero-copy tx segments */
+	struct completion done;
+	struct sk_buff_head tx_done_list; /* Referenced by zero-copy xfers */
+	void *tx_buf;
+	void *rx_buf;
+	void *rx_fallback_buf;
+	struct page *rx_page; /* Backs rx_buf if not NULL */
+	u16 rx_page_frags;
+	u16 xfer_count;
+	u16 tx_buf_offset;
+	u16 tx_chunks; /* Data valid tx chunks */
+	u16 length;
+	bool zc; /* Tx payloads are gathered from the skbs */
+	bool tx_packing; /* Tx frames may start mid chunk */
+};
+
+/* Who performs the control requests */
+enum oa_tc6_ctrl_state {
+	OA_TC6_CTRL_INLINE, /* The submitter, before the data engine runs */
+	OA_TC6_CTRL_QUEUED, /* The data engine, between data transfers */
+	OA_TC6_CTRL_STOPPED, /* Nobody, the device is going away */
+};
+
 /* Internal structure for MAC-PHY drivers */
 struct oa_tc6 {
 	struct device *dev;
@@ -115,21 +242,113 @@ struct oa_tc6 {
 	struct mii_bus *mdiobus;
 	struct spi_device *spi;
 	struct mutex spi_ctrl_lock; /* Protects spi control transfer */
-	void *spi_ctrl_tx_buf;
-	void *spi_ctrl_rx_buf;
-	void *spi_data_tx_buf;
-	void *spi_data_rx_buf;
-	struct sk_buff_head tx_skb_q;
+	struct mutex reg_cache_lock; /* Never held across a transfer */
+	DECLARE_HASHTABLE(reg_cache, OA_TC6_REG_CACHE_BITS);
+	bool (*volatile_reg)(u32 address);
+	struct oa_tc6_ctrl_buf spi_ctrl;
+	struct oa_tc6_ctrl_buf spi_data_ctrl; /* Of the SPI data transfers */
+	struct oa_tc6_txn_buf spi_txn; /* Of the control request executor */
+	spinlock_t ctrl_reqs_lock; /* Protects ctrl_reqs and ctrl_state */
+	struct list_head ctrl_reqs[OA_TC6_CTRL_PRIOS];
+	enum oa_tc6_ctrl_state ctrl_state;
+	struct u64_stats_sync ctrl_syncp;
+	struct oa_tc6_ctrl_stats ctrl_stats; /* Protected by ctrl_syncp */
+	struct u64_stats_sync err_syncp;
+	struct oa_tc6_error_stats err_stats; /* Protected by err_syncp */
+	struct u64_stats_sync data_syncp;
+	struct oa_tc6_data_stats data_stats; /* Protected by data_syncp */
+	struct oa_tc6_spi_data_buf spi_data_bufs[OA_TC6_SPI_DATA_BUFS];
+	struct oa_tc6_spi_data_buf *tx_data_buf; /* Being prepared */
+	struct oa_tc6_spi_data_buf *rx_data_buf; /* Being processed */
+	bool tx_zero_copy;
+	bool tx_packing;
+	u32 phyid;
+	u32 caps; /* OA_TC6_CAP_* of the MAC-PHY revision */
+	struct page_pool *page_pool;
+	u16 rx_frag_offset;
+	u16 rx_frag_len;
+	bool rx_frag_ongoing;
+	/* Single producer (ndo_start_xmit), single consumer (SPI thread) tx
+	 * skb ring. Each index is written by one side only.
+	 */
+	struct sk_buff *tx_ring[OA_TC6_TX_RING_SIZE];
+	u32 tx_ring_head ____cacheline_aligned_in_smp;
+	u32 tx_ring_tail ____cacheline_aligned_in_smp;
 	struct sk_buff *tx_skb;
 	struct sk_buff *rx_skb;
-	struct task_struct *spi_thread;
-	wait_queue_head_t spi_wq;
+	struct sk_buff_head rx_skb_list; /* Frames of the ongoing SPI transfer */
+	struct sk_buff_head rx_skb_q; /* Frames waiting for NAPI delivery */
+	struct sk_buff_head napi_rx_list; /* Private to the NAPI poll */
+	struct napi_struct napi;
+	struct oa_tc6_bus *bus; /* NULL in threaded irq mode */
+	struct list_head bus_node;
+	u32 bus_weight;
+	int bus_deficit; /* Chunks left to transfer in the scheduler round */
+	bool bus_pending; /* Ran out of deficit with work left */
+	u64 bus_time_ns; /* Bus statistics, protected by bus->syncp */
+	u64 bus_chunks;
+	u64 bus_ctrl_xfers;
+	u32 tx_skb_queue_size;
+	u32 tx_completed_bytes; /* BQL completions of the ongoing tx build */
+	u16 tx_completed_pkts;
 	u16 tx_skb_offset;
-	u16 spi_data_tx_buf_offset;
+	u16 tx_skb_frag_offset; /* Offset in the current tx skb fragment */
+	u8 tx_skb_frag; /* 0 for the linear part, n for the (n-1)th frag */
 	u16 tx_credits;
 	u8 rx_chunks_available;
 	bool rx_buf_overflow;
-	bool int_flag;
+	bool config_unsync; /* The MAC-PHY lost its configuration */
+	u8 recovery_attempts; /* Since the last good SPI data transfer */
+	u64 reset_start_ns; /* Of the ongoing MAC-PHY reset */
+	struct oa_tc6_rx_footers rx_footers; /* Of the last SPI data transfer */
+	struct oa_tc6_event_capture *event_capture;
+	bool hwtstamp_tx; /* Capture the tx timestamps the skbs ask for */
+	bool hwtstamp_rx; /* Report the rx timestamps */
+	struct sk_buff *tx_tstamp_skb; /* Waiting for its tx timestamp */
+	unsigned long tx_tstamp_start; /* In jiffies */
+	ktime_t rx_tstamp; /* Of the ongoing rx frame, 0 if none */
+	bool launch_time; /* Tx frames are held until their skb->tstamp */
+	s64 launch_latency_ns; /* Release to transmission, estimated */
+	s64 launch_release_ns; /* PHC time of the last launch time release */
+	s64 tx_tstamp_release_ns; /* Of tx_tstamp_skb, 0 if no launch time */
+	atomic64_t phc_offset_ns; /* PHC minus CLOCK_REALTIME */
+	struct hrtimer launch_timer; /* Wakes the engine for the next release */
+	bool threaded_irq;
+	struct mutex irq_thread_lock; /* Held by the irq thread during a run */
+	bool spi_failed; /* Data transfers stopped after an error */
+	unsigned long events; /* OA_TC6_EVENT_* bits */
+};
+
+/* The TC6 devices on one SPI controller share a scheduler thread, which
+ * interleaves their data and control transfers instead of letting them
+ * contend for the bus.
+ */
+struct oa_tc6_bus {
+	struct list_head node; /* In oa_tc6_buses */
+	struct spi_controller *ctlr;
+	unsigned int users;
+	struct task_struct *thread;
+	wait_queue_head_t wq;
+	bool work;
+	struct mutex ports_lock; /* Held by the thread during a round */
+	struct list_head ports;
+	struct u64_stats_sync syncp;
+	u64 time_ns; /* Bus time of all the ports */
+};
+
+/* Control request of a caller waiting for its completion */
+struct oa_tc6_ctrl_sync_req {
+	struct oa_tc6_ctrl_req req;
+	struct completion done;
+};
+
+static LIST_HEAD(oa_tc6_buses);
+static DEFINE_MUTEX(oa_tc6_buses_lock); /* Protects oa_tc6_buses */
+
+/* Reasons for running the SPI data transfer loop */
+enum oa_tc6_event {
+	OA_TC6_EVENT_IRQ, /* MAC-PHY interrupt, footers need to be read */
+	OA_TC6_EVENT_TX, /* Tx skbs queued */
 };
 
 enum oa_tc6_header_type {
@@ -142,11 +361,6 @@ enum oa_tc6_register_op {
 	OA_TC6_CTRL_REG_WRITE = 1,
 };
 
-enum oa_tc6_data_valid_info {
-	OA_TC6_DATA_INVALID,
-	OA_TC6_DATA_VALID,
-};
-
 enum oa_tc6_data_start_valid_info {
 	OA_TC6_DATA_START_INVALID,
 	OA_TC6_DATA_START_VALID,
@@ -157,38 +371,126 @@ enum oa_tc6_data_end_valid_info {
 	OA_TC6_DATA_END_VALID,
 };
 
-static int oa_tc6_spi_transfer(struct oa_tc6 *tc6,
-			       enum oa_tc6_header_type header_type, u16 length)
+static void oa_tc6_bus_kick(struct oa_tc6_bus *bus)
 {
-	struct spi_transfer xfer = { 0 };
-	struct spi_message msg;
+	/* Pairs with the barrier in oa_tc6_bus_thread_handler() */
+	smp_mb();
+	WRITE_ONCE(bus->work, true);
+	wake_up_interruptible(&bus->wq);
+}
 
-	if (header_type == OA_TC6_DATA_HEADER) {
-		xfer.tx_buf = tc6->spi_data_tx_buf;
-		xfer.rx_buf = tc6->spi_data_rx_buf;
-	} else {
-		xfer.tx_buf = tc6->spi_ctrl_tx_buf;
-		xfer.rx_buf = tc6->spi_ctrl_rx_buf;
+static void oa_tc6_kick_engine(struct oa_tc6 *tc6)
+{
+	if (tc6->threaded_irq)
+		irq_wake_thread(tc6->spi->irq, tc6);
+	else
+		oa_tc6_bus_kick(tc6->bus);
+}
+
+/* Queues a control request to the data engine, which performs it between two
+ * SPI data transfers. Returns 1 if the engine is not running yet and the
+ * submitter has to perform the request itself.
+ */
+static int oa_tc6_queue_ctrl_req(struct oa_tc6 *tc6,
+				 struct oa_tc6_ctrl_req *req)
+{
+	unsigned long flags;
+	int ret = 0;
+
+	req->submit_ns = ktime_get_ns();
+
+	spin_lock_irqsave(&tc6->ctrl_reqs_lock, flags);
+	switch (tc6->ctrl_state) {
+	case OA_TC6_CTRL_INLINE:
+		ret = 1;
+		break;
+	case OA_TC6_CTRL_QUEUED:
+		list_add_tail(&req->node, &tc6->ctrl_reqs[req->prio]);
+		oa_tc6_kick_engine(tc6);
+		break;
+	case OA_TC6_CTRL_STOPPED:
+		ret = -ENODEV;
+		break;
 	}
-	xfer.len = length;
+	spin_unlock_irqrestore(&tc6->ctrl_reqs_lock, flags);
+
+	return ret;
+}
+
+static bool oa_tc6_ctrl_req_aged(struct oa_tc6_ctrl_req *req)
+{
+	return ktime_get_ns() - req->submit_ns >
+	       OA_TC6_CTRL_LOW_PRIO_MAX_WAIT_NS;
+}
+
+/* Returns true if the data transfers have to make way for control requests */
+static bool oa_tc6_ctrl_req_waiting(struct oa_tc6 *tc6)
+{
+	struct oa_tc6_ctrl_req *req;
+	unsigned long flags;
+	bool waiting;
+
+	spin_lock_irqsave(&tc6->ctrl_reqs_lock, flags);
+	req = list_first_entry_or_null(&tc6->ctrl_reqs[OA_TC6_CTRL_PRIO_LOW],
+				       struct oa_tc6_ctrl_req, node);
+	waiting = !list_empty(&tc6->ctrl_reqs[OA_TC6_CTRL_PRIO_HIGH]) ||
+		  !list_empty(&tc6->ctrl_reqs[OA_TC6_CTRL_PRIO_NORMAL]) ||
+		  (req && oa_tc6_ctrl_req_aged(req));
+	spin_unlock_irqrestore(&tc6->ctrl_reqs_lock, flags);
+
+	return waiting;
+}
 
-	spi_message_init(&msg);
-	spi_message_add_tail(&xfer, &msg);
+static void oa_tc6_ctrl_sync_complete(struct oa_tc6_ctrl_req *req)
+{
+	struct oa_tc6_ctrl_sync_req *sync = container_of(req,
+							 struct oa_tc6_ctrl_sync_req,
+							 req);
 
-	return spi_sync(tc6->spi, &msg);
+	complete(&sync->done);
 }
 
-static int oa_tc6_get_parity(u32 p)
+static int oa_tc6_spi_sync_ctrl(struct oa_tc6 *tc6, struct spi_message *msg,
+				bool direct)
 {
-	/* Public domain code snippet, lifted from
-	 * http://www-graphics.stanford.edu/~seander/bithacks.html
+	struct oa_tc6_ctrl_sync_req sync = {
+		.req = {
+			.prio = OA_TC6_CTRL_PRIO_NORMAL,
+			.msg = msg,
+			.complete = oa_tc6_ctrl_sync_complete,
+		},
+	};
+	int ret;
+
+	/* Control transfers are performed by the data engine, unless they
+	 * are done by the SPI data transfers which already run in it.
 	 */
-	p ^= p >> 1;
-	p ^= p >> 2;
-	p = (p & 0x11111111U) * 0x11111111U;
+	if (direct)
+		return spi_sync(tc6->spi, msg);
+
+	init_completion(&sync.done);
+	ret = oa_tc6_queue_ctrl_req(tc6, &sync.req);
+	if (ret > 0)
+		return spi_sync(tc6->spi, msg);
+	if (ret)
+		return ret;
+
+	wait_for_completion(&sync.done);
+
+	return sync.req.ret;
+}
+
+static int oa_tc6_ctrl_transfer(struct oa_tc6 *tc6,
+				struct oa_tc6_ctrl_buf *ctrl, u16 length)
+{
+	struct spi_message *msg = &ctrl->reg_msg;
+
+	if (length != OA_TC6_CTRL_REG_SPI_SIZE) {
+		ctrl->xfer.len = length;
+		msg = &ctrl->msg;
+	}
 
-	/* Odd parity is used here */
-	return !((p >> 28) & 1);
+	return oa_tc6_spi_sync_ctrl(tc6, msg, ctrl == &tc6->spi_data_ctrl);
 }
 
 static __be32 oa_tc6_prepare_ctrl_header(u32 address, u8 length,
@@ -208,10 +510,10 @@ static __be32 oa_tc6_prepare_ctrl_header(u32 address, u8 length,
 	return cpu_to_be32(header);
 }
 
-static void oa_tc6_update_ctrl_write_data(struct oa_tc6 *tc6, u32 value[],
+static void oa_tc6_update_ctrl_write_data(void *ctrl_tx_buf, u32 value[],
 					  u8 length)
 {
-	__be32 *tx_buf = tc6->spi_ctrl_tx_buf + OA_TC6_CTRL_HEADER_SIZE;
+	__be32 *tx_buf = ctrl_tx_buf + OA_TC6_CTRL_HEADER_SIZE;
 
 	for (int i = 0; i < length; i++)
 		*tx_buf++ = cpu_to_be32(value[i]);
@@ -226,22 +528,23 @@ static u16 oa_tc6_calculate_ctrl_buf_size(u8 length)
 	       OA_TC6_CTRL_IGNORED_SIZE;
 }
 
-static void oa_tc6_prepare_ctrl_spi_buf(struct oa_tc6 *tc6, u32 address,
+static void oa_tc6_prepare_ctrl_spi_buf(void *ctrl_tx_buf, u32 address,
 					u32 value[], u8 length,
 					enum oa_tc6_register_op reg_op)
 {
-	__be32 *tx_buf = tc6->spi_ctrl_tx_buf;
+	__be32 *tx_buf = ctrl_tx_buf;
 
 	*tx_buf = oa_tc6_prepare_ctrl_header(address, length, reg_op);
 
 	if (reg_op == OA_TC6_CTRL_REG_WRITE)
-		oa_tc6_update_ctrl_write_data(tc6, value, length);
+		oa_tc6_update_ctrl_write_data(ctrl_tx_buf, value, length);
 }
 
-static int oa_tc6_check_ctrl_write_reply(struct oa_tc6 *tc6, u8 size)
+static int oa_tc6_check_ctrl_write_reply(void *ctrl_tx_buf, void *ctrl_rx_buf,
+					 u8 size)
 {
-	u8 *tx_buf = tc6->spi_ctrl_tx_buf;
-	u8 *rx_buf = tc6->spi_ctrl_rx_buf;
+	u8 *tx_buf = ctrl_tx_buf;
+	u8 *rx_buf = ctrl_rx_buf;
 
 	rx_buf += OA_TC6_CTRL_IGNORED_SIZE;
 
@@ -254,10 +557,10 @@ static int oa_tc6_check_ctrl_write_reply(struct oa_tc6 *tc6, u8 size)
 	return 0;
 }
 
-static int oa_tc6_check_ctrl_read_reply(struct oa_tc6 *tc6, u8 size)
+static int oa_tc6_check_ctrl_read_reply(void *ctrl_tx_buf, void *ctrl_rx_buf)
 {
-	u32 *tx_buf = tc6->spi_ctrl_tx_buf;
-	u32 *rx_buf = tc6->spi_ctrl_rx_buf + OA_TC6_CTRL_IGNORED_SIZE;
+	u32 *tx_buf = ctrl_tx_buf;
+	u32 *rx_buf = ctrl_rx_buf + OA_TC6_CTRL_IGNORED_SIZE;
 
 	/* The echoed control read header must match with the one that was
 	 * transmitted.
@@ -268,29 +571,37 @@ static int oa_tc6_check_ctrl_read_reply(struct oa_tc6 *tc6, u8 size)
 	return 0;
 }
 
-static void oa_tc6_copy_ctrl_read_data(struct oa_tc6 *tc6, u32 value[],
+static void oa_tc6_copy_ctrl_read_data(void *ctrl_rx_buf, u32 value[],
 				       u8 length)
 {
-	__be32 *rx_buf = tc6->spi_ctrl_rx_buf + OA_TC6_CTRL_IGNORED_SIZE +
+	__be32 *rx_buf = ctrl_rx_buf + OA_TC6_CTRL_IGNORED_SIZE +
 			 OA_TC6_CTRL_HEADER_SIZE;
 
 	for (int i = 0; i < length; i++)
 		value[i] = be32_to_cpu(*rx_buf++);
 }
 
-static int oa_tc6_perform_ctrl(struct oa_tc6 *tc6, u32 address, u32 value[],
-			       u8 length, enum oa_tc6_register_op reg_op)
+static int oa_tc6_perform_ctrl(struct oa_tc6 *tc6, struct oa_tc6_ctrl_buf *ctrl,
+			       u32 address, u32 value[], u8 length,
+			       enum oa_tc6_register_op reg_op)
 {
+	u64 start = 0;
 	u16 size;
 	int ret;
 
 	/* Prepare control command and copy to SPI control buffer */
-	oa_tc6_prepare_ctrl_spi_buf(tc6, address, value, length, reg_op);
+	oa_tc6_prepare_ctrl_spi_buf(ctrl->tx_buf, address, value, length,
+				    reg_op);
 
 	size = oa_tc6_calculate_ctrl_buf_size(length);
 
 	/* Perform SPI transfer */
-	ret = oa_tc6_spi_transfer(tc6, OA_TC6_CTRL_HEADER, size);
+	if (trace_oa_tc6_ctrl_access_enabled())
+		start = ktime_get_ns();
+	ret = oa_tc6_ctrl_transfer(tc6, ctrl, size);
+	trace_oa_tc6_ctrl_access(tc6->netdev, address, length,
+				 reg_op == OA_TC6_CTRL_REG_WRITE,
+				 start ? ktime_get_ns() - start : 0, ret);
 	if (ret) {
 		dev_err(&tc6->spi->dev, "SPI transfer failed for control: %d\n",
 			ret);
@@ -299,18 +610,146 @@ static int oa_tc6_perform_ctrl(struct oa_tc6 *tc6, u32 address, u32 value[],
 
 	/* Check echoed/received control write command reply for errors */
 	if (reg_op == OA_TC6_CTRL_REG_WRITE)
-		return oa_tc6_check_ctrl_write_reply(tc6, size);
+		return oa_tc6_check_ctrl_write_reply(ctrl->tx_buf, ctrl->rx_buf,
+						     size);
 
 	/* Check echoed/received control read command reply for errors */
-	ret = oa_tc6_check_ctrl_read_reply(tc6, size);
+	ret = oa_tc6_check_ctrl_read_reply(ctrl->tx_buf, ctrl->rx_buf);
 	if (ret)
 		return ret;
 
-	oa_tc6_copy_ctrl_read_data(tc6, value, length);
+	oa_tc6_copy_ctrl_read_data(ctrl->rx_buf, value, length);
 
 	return 0;
 }
 
+/* Register accesses of the SPI data transfer context use their own control
+ * buffers, so they never wait for the other users of the control interface.
+ * On a shared bus those may be waiting for the very same context.
+ */
+static int oa_tc6_data_read_registers(struct oa_tc6 *tc6, u32 address,
+				      u32 value[], u8 length)
+{
+	return oa_tc6_perform_ctrl(tc6, &tc6->spi_data_ctrl, address, value,
+				   length, OA_TC6_CTRL_REG_READ);
+}
+
+static int oa_tc6_data_read_register(struct oa_tc6 *tc6, u32 address,
+				     u32 *value)
+{
+	return oa_tc6_data_read_registers(tc6, address, value, 1);
+}
+
+static int oa_tc6_data_write_registers(struct oa_tc6 *tc6, u32 address,
+				       u32 value[], u8 length)
+{
+	return oa_tc6_perform_ctrl(tc6, &tc6->spi_data_ctrl, address, value,
+				   length, OA_TC6_CTRL_REG_WRITE);
+}
+
+static int oa_tc6_data_write_register(struct oa_tc6 *tc6, u32 address,
+				      u32 value)
+{
+	return oa_tc6_data_write_registers(tc6, address, &value, 1);
+}
+
+static bool oa_tc6_volatile_reg(struct oa_tc6 *tc6, u32 address)
+{
+	switch (address) {
+	case OA_TC6_REG_RESET:
+	case OA_TC6_REG_STATUS0:
+	case OA_TC6_REG_STATUS1:
+	case OA_TC6_REG_BUFFER_STATUS:
+		return true;
+	}
+
+	/* PHY registers hold status and counters, they are left to phylib */
+	if (address >> 16 > 1 ||
+	    (!(address >> 16) && address >= OA_TC6_PHY_STD_REG_ADDR_BASE))
+		return true;
+
+	return tc6->volatile_reg && tc6->volatile_reg(address);
+}
+
+static struct oa_tc6_reg_cache_entry *oa_tc6_reg_cache_find(struct oa_tc6 *tc6,
+							    u32 address)
+{
+	struct oa_tc6_reg_cache_entry *entry;
+
+	hash_for_each_possible(tc6->reg_cache, entry, node, address)
+		if (entry->address == address)
+			return entry;
+
+	return NULL;
+}
+
+static bool oa_tc6_reg_cache_read(struct oa_tc6 *tc6, u32 address,
+				  u32 *value)
+{
+	struct oa_tc6_reg_cache_entry *entry;
+
+	mutex_lock(&tc6->reg_cache_lock);
+	entry = oa_tc6_reg_cache_find(tc6, address);
+	if (entry)
+		*value = entry->value;
+	mutex_unlock(&tc6->reg_cache_lock);
+
+	return !!entry;
+}
+
+static void oa_tc6_reg_cache_update(struct oa_tc6 *tc6, u32 address,
+				    u32 value[], u8 length)
+{
+	struct oa_tc6_reg_cache_entry *entry;
+
+	mutex_lock(&tc6->reg_cache_lock);
+	for (int i = 0; i < length; i++, address++) {
+		if (oa_tc6_volatile_reg(tc6, address))
+			continue;
+
+		entry = oa_tc6_reg_cache_find(tc6, address);
+		if (!entry) {
+			/* The register is just not cached if this fails */
+			entry = kmalloc(sizeof(*entry), GFP_KERNEL);
+			if (!entry)
+				continue;
+			entry->address = address;
+			hash_add(tc6->reg_cache, &entry->node, address);
+		}
+		entry->value = value[i];
+	}
+	mutex_unlock(&tc6->reg_cache_lock);
+}
+
+static bool oa_tc6_reg_cache_match(struct oa_tc6 *tc6, u32 address,
+				   u32 value[], u8 length)
+{
+	u32 cached;
+
+	for (int i = 0; i < length; i++, address++) {
+		if (oa_tc6_volatile_reg(tc6, address) ||
+		    !oa_tc6_reg_cache_read(tc6, address, &cached) ||
+		    cached != value[i])
+			return false;
+	}
+
+	return true;
+}
+
+static void oa_tc6_reg_cache_drop(struct oa_tc6 *tc6)
+{
+	struct oa_tc6_reg_cache_entry *entry;
+	struct hlist_node *tmp;
+	int bkt;
+
+	mutex_lock(&tc6->reg_cache_lock);
+	hash_for_each_safe(tc6->reg_cache, bkt, tmp, entry, node) {
+		hash_del(&entry->node);
+		kfree(entry);
+	}
+	mutex_unlock(&tc6->reg_cache_lock);
+}
+
 /**
  * oa_tc6_read_registers - function for reading multiple consecutive registers.
  * @tc6: oa_tc6 struct.
@@ -319,6 +758,9 @@ static int oa_tc6_perform_ctrl(struct oa_tc6 *tc6, u32 address, u32 value[],
  * @length: number of consecutive registers to be read from @address.
  *
  * Maximum of 128 consecutive registers can be read starting at @address.
+ * A single non-volatile register is served from the register cache if
+ * possible, while multiple registers are always read from the MAC-PHY as
+ * one consistent snapshot.
  *
  * Returns 0 on success otherwise failed.
  */
@@ -332,15 +774,77 @@ int oa_tc6_read_registers(struct oa_tc6 *tc6, u32 address, u32 value[],
 		return -EINVAL;
 	}
 
+	if (length == 1 && oa_tc6_reg_cache_read(tc6, address, value))
+		return 0;
+
 	mutex_lock(&tc6->spi_ctrl_lock);
-	ret = oa_tc6_perform_ctrl(tc6, address, value, length,
+	ret = oa_tc6_perform_ctrl(tc6, &tc6->spi_ctrl, address, value, length,
 				  OA_TC6_CTRL_REG_READ);
+	if (!ret)
+		oa_tc6_reg_cache_update(tc6, address, value, length);
 	mutex_unlock(&tc6->spi_ctrl_lock);
 
 	return ret;
 }
 EXPORT_SYMBOL_GPL(oa_tc6_read_registers);
 
+/**
+ * oa_tc6_read_registers_sts - function for reading multiple consecutive
+ * registers with system timestamps taken around one of them.
+ * @tc6: oa_tc6 struct.
+ * @address: address of the first register to be read in the MAC-PHY.
+ * @value: values to be read from the starting register address @address.
+ * @length: number of consecutive registers to be read from @address.
+ * @index: index of the register in @value the timestamps are taken around.
+ * @sts: system timestamps, taken before the MAC-PHY fetches the register
+ * @index, that is while the word preceding it is shifted, and after its first
+ * byte is shifted.
+ *
+ * The timestamps are taken by the SPI controller driver if it supports it,
+ * otherwise by the SPI core around the whole control transfer. Either way
+ * they don't include the time the control request waited for the SPI data
+ * transfers. The registers are always read from the MAC-PHY.
+ *
+ * Returns 0 on success otherwise failed.
+ */
+int oa_tc6_read_registers_sts(struct oa_tc6 *tc6, u32 address, u32 value[],
+			      u8 length, u8 index,
+			      struct ptp_system_timestamp *sts)
+{
+	struct spi_transfer *xfer;
+	u32 offset;
+	int ret;
+
+	if (!length || length > OA_TC6_CTRL_MAX_REGISTERS || index >= length) {
+		dev_err(&tc6->spi->dev, "Invalid register length parameter\n");
+		return -EINVAL;
+	}
+
+	/* The register values follow the ignored bytes and the echoed header */
+	offset = OA_TC6_CTRL_IGNORED_SIZE + OA_TC6_CTRL_HEADER_SIZE +
+		 index * OA_TC6_CTRL_REG_VALUE_SIZE;
+
+	mutex_lock(&tc6->spi_ctrl_lock);
+	if (length == 1)
+		xfer = &tc6->spi_ctrl.reg_xfer;
+	else
+		xfer = &tc6->spi_ctrl.xfer;
+	xfer->ptp_sts = sts;
+	xfer->ptp_sts_word_pre = offset - OA_TC6_CTRL_REG_VALUE_SIZE;
+	xfer->ptp_sts_word_post = offset;
+
+	ret = oa_tc6_perform_ctrl(tc6, &tc6->spi_ctrl, address, value, length,
+				  OA_TC6_CTRL_REG_READ);
+	if (!ret)
+		oa_tc6_reg_cache_update(tc6, address, value, length);
+
+	xfer->ptp_sts = NULL;
+	mutex_unlock(&tc6->spi_ctrl_lock);
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(oa_tc6_read_registers_sts);
+
 /**
  * oa_tc6_read_register - function for reading a MAC-PHY register.
  * @tc6: oa_tc6 struct.
@@ -363,13 +867,15 @@ EXPORT_SYMBOL_GPL(oa_tc6_read_register);
  * @length: number of consecutive registers to be written from @address.
  *
  * Maximum of 128 consecutive registers can be written starting at @address.
+ * The write is skipped if all the registers are non-volatile and already
+ * hold the values according to the register cache.
  *
  * Returns 0 on success otherwise failed.
  */
 int oa_tc6_write_registers(struct oa_tc6 *tc6, u32 address, u32 value[],
 			   u8 length)
 {
-	int ret;
+	int ret = 0;
 
 	if (!length || length > OA_TC6_CTRL_MAX_REGISTERS) {
 		dev_err(&tc6->spi->dev, "Invalid register length parameter\n");
@@ -377,8 +883,12 @@ int oa_tc6_write_registers(struct oa_tc6 *tc6, u32 address, u32 value[],
 	}
 
 	mutex_lock(&tc6->spi_ctrl_lock);
-	ret = oa_tc6_perform_ctrl(tc6, address, value, length,
-				  OA_TC6_CTRL_REG_WRITE);
+	if (!oa_tc6_reg_cache_match(tc6, address, value, length)) {
+		ret = oa_tc6_perform_ctrl(tc6, &tc6->spi_ctrl, address, value,
+					  length, OA_TC6_CTRL_REG_WRITE);
+		if (!ret)
+			oa_tc6_reg_cache_update(tc6, address, value, length);
+	}
 	mutex_unlock(&tc6->spi_ctrl_lock);
 
 	return ret;
@@ -399,116 +909,545 @@ int oa_tc6_write_register(struct oa_tc6 *tc6, u32 address, u32 value)
 }
 EXPORT_SYMBOL_GPL(oa_tc6_write_register);
 
-static int oa_tc6_check_phy_reg_direct_access_capability(struct oa_tc6 *tc6)
+/**
+ * oa_tc6_txn_init - function for starting a control transaction.
+ * @txn: transaction to be initialized.
+ */
+void oa_tc6_txn_init(struct oa_tc6_txn *txn)
 {
-	u32 regval;
-	int ret;
+	txn->count = 0;
+}
+EXPORT_SYMBOL_GPL(oa_tc6_txn_init);
 
-	ret = oa_tc6_read_register(tc6, OA_TC6_REG_STDCAP, &regval);
-	if (ret)
-		return ret;
+static int oa_tc6_txn_add(struct oa_tc6_txn *txn, enum oa_tc6_txn_op_type type,
+			  u32 address, u32 mask, u32 value)
+{
+	struct oa_tc6_txn_op *op;
 
-	if (!(regval & STDCAP_DIRECT_PHY_REG_ACCESS))
-		return -ENODEV;
+	if (txn->count == OA_TC6_TXN_MAX_OPS)
+		return -ENOSPC;
 
-	return 0;
+	op = &txn->ops[txn->count];
+	op->type = type;
+	op->address = address;
+	op->mask = mask;
+	op->value = value;
+	op->status = 0;
+
+	return txn->count++;
 }
 
-static void oa_tc6_handle_link_change(struct net_device *netdev)
+/**
+ * oa_tc6_txn_read - function for adding a register read to a transaction.
+ * @txn: transaction to be extended.
+ * @address: register address of the MAC-PHY to be read.
+ *
+ * Returns the index of the operation in @txn->ops, whose value holds the
+ * register value after the transaction is executed, or -ENOSPC.
+ */
+int oa_tc6_txn_read(struct oa_tc6_txn *txn, u32 address)
 {
-	phy_print_status(netdev->phydev);
+	return oa_tc6_txn_add(txn, OA_TC6_TXN_READ, address, 0, 0);
 }
+EXPORT_SYMBOL_GPL(oa_tc6_txn_read);
 
-static int oa_tc6_mdiobus_read(struct mii_bus *bus, int addr, int regnum)
+/**
+ * oa_tc6_txn_write - function for adding a register write to a transaction.
+ * @txn: transaction to be extended.
+ * @address: register address of the MAC-PHY to be written.
+ * @value: value to be written in the @address register.
+ *
+ * Returns the index of the operation in @txn->ops or -ENOSPC.
+ */
+int oa_tc6_txn_write(struct oa_tc6_txn *txn, u32 address, u32 value)
 {
-	struct oa_tc6 *tc6 = bus->priv;
-	u32 regval;
-	bool ret;
+	return oa_tc6_txn_add(txn, OA_TC6_TXN_WRITE, address, U32_MAX, value);
+}
+EXPORT_SYMBOL_GPL(oa_tc6_txn_write);
 
-	ret = oa_tc6_read_register(tc6, OA_TC6_PHY_STD_REG_ADDR_BASE |
-				   (regnum & OA_TC6_PHY_STD_REG_ADDR_MASK),
-				   &regval);
-	if (ret)
-		return -ENODEV;
+/**
+ * oa_tc6_txn_update - function for adding a register read-modify-write to a
+ * transaction.
+ * @txn: transaction to be extended.
+ * @address: register address of the MAC-PHY to be updated.
+ * @mask: bits of the register to be updated.
+ * @value: new value of the bits in @mask.
+ *
+ * Returns the index of the operation in @txn->ops, whose value holds the
+ * written register value after the transaction is executed, or -ENOSPC.
+ */
+int oa_tc6_txn_update(struct oa_tc6_txn *txn, u32 address, u32 mask,
+		      u32 value)
+{
+	return oa_tc6_txn_add(txn, OA_TC6_TXN_UPDATE, address, mask, value);
+}
+EXPORT_SYMBOL_GPL(oa_tc6_txn_update);
 
-	return regval;
+/* Returns the value the register of the @index op holds before the op, if it
+ * is known without reading it. That is the value written by the latest
+ * earlier write or update of the register in the transaction, otherwise the
+ * cached value. It is unknown if that write or update failed.
+ */
+static bool oa_tc6_txn_known_value(struct oa_tc6 *tc6, struct oa_tc6_txn *txn,
+				   int index, u32 *value)
+{
+	u32 address = txn->ops[index].address;
+
+	for (int i = index - 1; i >= 0; i--) {
+		if (txn->ops[i].address == address &&
+		    txn->ops[i].type != OA_TC6_TXN_READ) {
+			if (txn->ops[i].status)
+				return false;
+
+			*value = txn->ops[i].value;
+			return true;
+		}
+	}
+
+	if (oa_tc6_volatile_reg(tc6, address))
+		return false;
+
+	return oa_tc6_reg_cache_read(tc6, address, value);
 }
 
-static int oa_tc6_mdiobus_write(struct mii_bus *bus, int addr, int regnum,
-				u16 val)
+/* An update based on an earlier write or update of the register in the
+ * transaction fails with it, as the register value it modifies is unknown.
+ */
+static int oa_tc6_txn_base_status(struct oa_tc6_txn *txn, int index)
 {
-	struct oa_tc6 *tc6 = bus->priv;
+	u32 address = txn->ops[index].address;
 
-	return oa_tc6_write_register(tc6, OA_TC6_PHY_STD_REG_ADDR_BASE |
-				     (regnum & OA_TC6_PHY_STD_REG_ADDR_MASK),
-				     val);
+	for (int i = index - 1; i >= 0; i--)
+		if (txn->ops[i].address == address &&
+		    txn->ops[i].type != OA_TC6_TXN_READ)
+			return txn->ops[i].status;
+
+	return 0;
 }
 
-static int oa_tc6_get_phy_c45_mms(int devnum)
+static void oa_tc6_txn_add_cmd(struct oa_tc6_txn_buf *buf, u8 slot,
+			       u32 address, u32 *value,
+			       enum oa_tc6_register_op reg_op)
 {
-	switch (devnum) {
-	case MDIO_MMD_PCS:
-		return OA_TC6_PHY_C45_PCS_MMS2;
-	case MDIO_MMD_PMAPMD:
-		return OA_TC6_PHY_C45_PMA_PMD_MMS3;
-	case MDIO_MMD_VEND2:
-		return OA_TC6_PHY_C45_VS_PLCA_MMS4;
-	case MDIO_MMD_AN:
-		return OA_TC6_PHY_C45_AUTO_NEG_MMS5;
-	case MDIO_MMD_POWER_UNIT:
-		return OA_TC6_PHY_C45_POWER_UNIT_MMS6;
-	default:
-		return -EOPNOTSUPP;
-	}
+	struct spi_transfer *xfer = &buf->xfers[slot];
+
+	memset(xfer, 0, sizeof(*xfer));
+	xfer->tx_buf = buf->tx_buf + slot * OA_TC6_CTRL_REG_SPI_SIZE;
+	xfer->rx_buf = buf->rx_buf + slot * OA_TC6_CTRL_REG_SPI_SIZE;
+	xfer->len = OA_TC6_CTRL_REG_SPI_SIZE;
+	/* Every control command is framed by its own chip select */
+	xfer->cs_change = 1;
+
+	oa_tc6_prepare_ctrl_spi_buf((void *)xfer->tx_buf, address, value, 1,
+				    reg_op);
 }
 
-static int oa_tc6_mdiobus_read_c45(struct mii_bus *bus, int addr, int devnum,
-				   int regnum)
+static int oa_tc6_txn_transfer(struct oa_tc6 *tc6, u8 count)
 {
-	struct oa_tc6 *tc6 = bus->priv;
-	u32 regval;
+	struct oa_tc6_txn_buf *buf = &tc6->spi_txn;
 	int ret;
 
-	ret = oa_tc6_get_phy_c45_mms(devnum);
-	if (ret < 0)
-		return ret;
+	/* The chip select is released at the end of the message anyway */
+	buf->xfers[count - 1].cs_change = 0;
+	spi_message_init_with_transfers(&buf->msg, buf->xfers, count);
 
-	ret = oa_tc6_read_register(tc6, (ret << 16) | regnum, &regval);
+	ret = spi_sync(tc6->spi, &buf->msg);
 	if (ret)
-		return ret;
+		dev_err(&tc6->spi->dev, "SPI transfer failed for control: %d\n",
+			ret);
 
-	return regval;
+	return ret;
 }
 
-static int oa_tc6_mdiobus_write_c45(struct mii_bus *bus, int addr, int devnum,
-				    int regnum, u16 val)
+static int oa_tc6_txn_check_reply(struct oa_tc6_txn_buf *buf, u8 slot,
+				  u32 *value, enum oa_tc6_register_op reg_op)
 {
-	struct oa_tc6 *tc6 = bus->priv;
+	void *tx_buf = buf->tx_buf + slot * OA_TC6_CTRL_REG_SPI_SIZE;
+	void *rx_buf = buf->rx_buf + slot * OA_TC6_CTRL_REG_SPI_SIZE;
 	int ret;
 
-	ret = oa_tc6_get_phy_c45_mms(devnum);
-	if (ret < 0)
+	if (reg_op == OA_TC6_CTRL_REG_WRITE)
+		return oa_tc6_check_ctrl_write_reply(tx_buf, rx_buf,
+						     OA_TC6_CTRL_REG_SPI_SIZE);
+
+	ret = oa_tc6_check_ctrl_read_reply(tx_buf, rx_buf);
+	if (ret)
 		return ret;
 
-	return oa_tc6_write_register(tc6, (ret << 16) | regnum, val);
+	oa_tc6_copy_ctrl_read_data(rx_buf, value, 1);
+
+	return 0;
 }
 
-static int oa_tc6_mdiobus_register(struct oa_tc6 *tc6)
+/* Reads the current values of the registers to be updated which are neither
+ * cached nor written before in the transaction.
+ */
+static void oa_tc6_txn_read_update_bases(struct oa_tc6 *tc6,
+					 struct oa_tc6_txn *txn, u32 base[],
+					 bool read[])
 {
+	struct oa_tc6_txn_buf *buf = &tc6->spi_txn;
+	u8 slots[OA_TC6_TXN_MAX_OPS];
+	u8 count = 0;
 	int ret;
 
-	tc6->mdiobus = mdiobus_alloc();
-	if (!tc6->mdiobus) {
-		netdev_err(tc6->netdev, "MDIO bus alloc failed\n");
-		return -ENOMEM;
+	for (int i = 0; i < txn->count; i++) {
+		read[i] = false;
+		if (txn->ops[i].type != OA_TC6_TXN_UPDATE ||
+		    oa_tc6_txn_known_value(tc6, txn, i, &base[i]))
+			continue;
+
+		read[i] = true;
+		slots[i] = count;
+		oa_tc6_txn_add_cmd(buf, count++, txn->ops[i].address, NULL,
+				   OA_TC6_CTRL_REG_READ);
 	}
 
-	tc6->mdiobus->priv = tc6;
-	tc6->mdiobus->read = oa_tc6_mdiobus_read;
-	tc6->mdiobus->write = oa_tc6_mdiobus_write;
-	/* OPEN Alliance 10BASE-T1x compliance MAC-PHYs will have both C22 and
-	 * C45 registers space. If the PHY is discovered via C22 bus protocol it
-	 * assumes it uses C22 protocol and always uses C22 registers indirect
+	if (!count)
+		return;
+
+	ret = oa_tc6_txn_transfer(tc6, count);
+
+	for (int i = 0; i < txn->count; i++) {
+		if (!read[i])
+			continue;
+
+		txn->ops[i].status = ret ?:
+			oa_tc6_txn_check_reply(buf, slots[i], &base[i],
+					       OA_TC6_CTRL_REG_READ);
+		if (!txn->ops[i].status)
+			oa_tc6_reg_cache_update(tc6, txn->ops[i].address,
+						&base[i], 1);
+	}
+}
+
+/* All the register accesses of the transaction are performed in order in one
+ * SPI message. Reads and writes are served by the register cache like single
+ * register accesses. Read-modify-writes of registers which are neither cached
+ * nor written before in the transaction need their current values, which are
+ * read in one additional SPI message first.
+ *
+ * Only the control request executor performs transactions, so the buffers
+ * need no lock.
+ */
+static int oa_tc6_txn_run(struct oa_tc6 *tc6, struct oa_tc6_txn *txn)
+{
+	struct oa_tc6_txn_buf *buf = &tc6->spi_txn;
+	enum oa_tc6_register_op reg_ops[OA_TC6_TXN_MAX_OPS];
+	bool read[OA_TC6_TXN_MAX_OPS];
+	u32 base[OA_TC6_TXN_MAX_OPS];
+	u8 slots[OA_TC6_TXN_MAX_OPS];
+	struct oa_tc6_txn_op *op;
+	u64 start = 0;
+	u8 count = 0;
+	bool known;
+	int ret;
+
+	if (!txn->count)
+		return 0;
+
+	oa_tc6_txn_read_update_bases(tc6, txn, base, read);
+
+	for (int i = 0; i < txn->count; i++) {
+		op = &txn->ops[i];
+		slots[i] = U8_MAX;
+		if (!op->status && op->type == OA_TC6_TXN_UPDATE && !read[i])
+			op->status = oa_tc6_txn_base_status(txn, i);
+		if (op->status)
+			continue;
+
+		known = read[i] || oa_tc6_txn_known_value(tc6, txn, i,
+							  &base[i]);
+		if (op->type == OA_TC6_TXN_READ) {
+			if (known && !oa_tc6_volatile_reg(tc6, op->address)) {
+				op->value = base[i];
+				continue;
+			}
+			reg_ops[i] = OA_TC6_CTRL_REG_READ;
+		} else {
+			if (op->type == OA_TC6_TXN_UPDATE)
+				op->value = (base[i] & ~op->mask) |
+					    (op->value & op->mask);
+
+			/* Writes of unchanged values are skipped */
+			if (known && base[i] == op->value &&
+			    !oa_tc6_volatile_reg(tc6, op->address))
+				continue;
+			reg_ops[i] = OA_TC6_CTRL_REG_WRITE;
+		}
+
+		slots[i] = count;
+		oa_tc6_txn_add_cmd(buf, count++, op->address, &op->value,
+				   reg_ops[i]);
+	}
+
+	if (count) {
+		if (trace_oa_tc6_ctrl_txn_enabled())
+			start = ktime_get_ns();
+		ret = oa_tc6_txn_transfer(tc6, count);
+		trace_oa_tc6_ctrl_txn(tc6->netdev, count,
+				      start ? ktime_get_ns() - start : 0, ret);
+	} else {
+		ret = 0;
+	}
+
+	for (int i = 0; i < txn->count; i++) {
+		op = &txn->ops[i];
+		if (slots[i] == U8_MAX)
+			continue;
+
+		op->status = ret ?: oa_tc6_txn_check_reply(buf, slots[i],
+							   &op->value,
+							   reg_ops[i]);
+		if (!op->status)
+			oa_tc6_reg_cache_update(tc6, op->address, &op->value,
+						1);
+	}
+
+	for (int i = 0; i < txn->count; i++)
+		if (txn->ops[i].status)
+			return txn->ops[i].status;
+
+	return 0;
+}
+
+static void oa_tc6_txn_req_complete(struct oa_tc6_ctrl_req *req)
+{
+	struct oa_tc6_txn *txn = container_of(req, struct oa_tc6_txn, req);
+
+	txn->complete(txn, req->ret);
+}
+
+/**
+ * oa_tc6_txn_submit - function for queueing a control transaction.
+ * @tc6: oa_tc6 struct.
+ * @txn: transaction to be executed, it must stay valid until completed.
+ * @prio: priority of the transaction against the data transfers.
+ * @complete: called with 0 if all the operations succeeded otherwise the
+ * first error.
+ * @context: stored in @txn for @complete.
+ *
+ * The transaction is performed by the data engine between two SPI data
+ * transfers. High priority transactions are performed before the next data
+ * transfer. Normal ones are interleaved with the data transfers, at most
+ * ctrl_round_cap of them at a time. Low priority ones wait until the data path
+ * is idle, but at most for 10ms.
+ *
+ * @complete runs in the data engine and must not wait for other control
+ * accesses. Until the data engine runs, that is during oa_tc6_init(), the
+ * transaction is performed and completed right away.
+ */
+void oa_tc6_txn_submit(struct oa_tc6 *tc6, struct oa_tc6_txn *txn,
+		       enum oa_tc6_ctrl_prio prio,
+		       void (*complete)(struct oa_tc6_txn *txn, int status),
+		       void *context)
+{
+	int ret;
+
+	txn->complete = complete;
+	txn->context = context;
+	txn->req.prio = prio;
+	txn->req.msg = NULL;
+	txn->req.complete = oa_tc6_txn_req_complete;
+
+	ret = oa_tc6_queue_ctrl_req(tc6, &txn->req);
+	if (!ret)
+		return;
+
+	if (ret > 0)
+		ret = oa_tc6_txn_run(tc6, txn);
+
+	txn->req.ret = ret;
+	complete(txn, ret);
+}
+EXPORT_SYMBOL_GPL(oa_tc6_txn_submit);
+
+static void oa_tc6_txn_sync_complete(struct oa_tc6_txn *txn, int status)
+{
+	complete(txn->context);
+}
+
+/**
+ * oa_tc6_txn_execute - function for executing a control transaction.
+ * @tc6: oa_tc6 struct.
+ * @txn: transaction to be executed.
+ * @prio: priority of the transaction against the data transfers.
+ *
+ * Synchronous variant of oa_tc6_txn_submit(). The status of every operation
+ * is stored in its status field.
+ *
+ * Returns 0 if all the operations succeeded otherwise the first error.
+ */
+int oa_tc6_txn_execute(struct oa_tc6 *tc6, struct oa_tc6_txn *txn,
+		       enum oa_tc6_ctrl_prio prio)
+{
+	DECLARE_COMPLETION_ONSTACK(done);
+
+	oa_tc6_txn_submit(tc6, txn, prio, oa_tc6_txn_sync_complete, &done);
+	wait_for_completion(&done);
+
+	return txn->req.ret;
+}
+EXPORT_SYMBOL_GPL(oa_tc6_txn_execute);
+
+/**
+ * oa_tc6_update_register - function for a read-modify-write of a MAC-PHY
+ * register.
+ * @tc6: oa_tc6 struct.
+ * @address: register address of the MAC-PHY to be updated.
+ * @mask: bits of the register to be updated.
+ * @value: new value of the bits in @mask.
+ *
+ * Returns 0 on success otherwise failed.
+ */
+int oa_tc6_update_register(struct oa_tc6 *tc6, u32 address, u32 mask,
+			   u32 value)
+{
+	struct oa_tc6_txn txn;
+
+	oa_tc6_txn_init(&txn);
+	oa_tc6_txn_update(&txn, address, mask, value);
+
+	return oa_tc6_txn_execute(tc6, &txn, OA_TC6_CTRL_PRIO_NORMAL);
+}
+EXPORT_SYMBOL_GPL(oa_tc6_update_register);
+
+static int oa_tc6_read_revision(struct oa_tc6 *tc6)
+{
+	const struct oa_tc6_revision *rev;
+	int ret;
+
+	ret = oa_tc6_read_register(tc6, OA_TC6_REG_PHYID, &tc6->phyid);
+	if (ret)
+		return ret;
+
+	/* Unknown revisions get the mandatory capabilities only */
+	for (int i = 0; i < ARRAY_SIZE(oa_tc6_revisions); i++) {
+		rev = &oa_tc6_revisions[i];
+		if ((tc6->phyid & rev->phyid_mask) != rev->phyid)
+			continue;
+
+		tc6->caps = rev->caps;
+		dev_dbg(&tc6->spi->dev, "%s, capabilities 0x%x\n", rev->name,
+			tc6->caps);
+		break;
+	}
+
+	tc6->tx_packing = tc6->caps & OA_TC6_CAP_TX_PACKING;
+
+	return 0;
+}
+
+static int oa_tc6_check_phy_reg_direct_access_capability(struct oa_tc6 *tc6)
+{
+	u32 regval;
+	int ret;
+
+	ret = oa_tc6_read_register(tc6, OA_TC6_REG_STDCAP, &regval);
+	if (ret)
+		return ret;
+
+	if (!(regval & STDCAP_DIRECT_PHY_REG_ACCESS))
+		return -ENODEV;
+
+	return 0;
+}
+
+static void oa_tc6_handle_link_change(struct net_device *netdev)
+{
+	phy_print_status(netdev->phydev);
+}
+
+static int oa_tc6_mdiobus_read(struct mii_bus *bus, int addr, int regnum)
+{
+	struct oa_tc6 *tc6 = bus->priv;
+	u32 regval;
+	bool ret;
+
+	ret = oa_tc6_read_register(tc6, OA_TC6_PHY_STD_REG_ADDR_BASE |
+				   (regnum & OA_TC6_PHY_STD_REG_ADDR_MASK),
+				   &regval);
+	if (ret)
+		return -ENODEV;
+
+	return regval;
+}
+
+static int oa_tc6_mdiobus_write(struct mii_bus *bus, int addr, int regnum,
+				u16 val)
+{
+	struct oa_tc6 *tc6 = bus->priv;
+
+	return oa_tc6_write_register(tc6, OA_TC6_PHY_STD_REG_ADDR_BASE |
+				     (regnum & OA_TC6_PHY_STD_REG_ADDR_MASK),
+				     val);
+}
+
+static int oa_tc6_get_phy_c45_mms(int devnum)
+{
+	switch (devnum) {
+	case MDIO_MMD_PCS:
+		return OA_TC6_PHY_C45_PCS_MMS2;
+	case MDIO_MMD_PMAPMD:
+		return OA_TC6_PHY_C45_PMA_PMD_MMS3;
+	case MDIO_MMD_VEND2:
+		return OA_TC6_PHY_C45_VS_PLCA_MMS4;
+	case MDIO_MMD_AN:
+		return OA_TC6_PHY_C45_AUTO_NEG_MMS5;
+	case MDIO_MMD_POWER_UNIT:
+		return OA_TC6_PHY_C45_POWER_UNIT_MMS6;
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+
+static int oa_tc6_mdiobus_read_c45(struct mii_bus *bus, int addr, int devnum,
+				   int regnum)
+{
+	struct oa_tc6 *tc6 = bus->priv;
+	u32 regval;
+	int ret;
+
+	ret = oa_tc6_get_phy_c45_mms(devnum);
+	if (ret < 0)
+		return ret;
+
+	ret = oa_tc6_read_register(tc6, (ret << 16) | regnum, &regval);
+	if (ret)
+		return ret;
+
+	return regval;
+}
+
+static int oa_tc6_mdiobus_write_c45(struct mii_bus *bus, int addr, int devnum,
+				    int regnum, u16 val)
+{
+	struct oa_tc6 *tc6 = bus->priv;
+	int ret;
+
+	ret = oa_tc6_get_phy_c45_mms(devnum);
+	if (ret < 0)
+		return ret;
+
+	return oa_tc6_write_register(tc6, (ret << 16) | regnum, val);
+}
+
+static int oa_tc6_mdiobus_register(struct oa_tc6 *tc6)
+{
+	int ret;
+
+	tc6->mdiobus = mdiobus_alloc();
+	if (!tc6->mdiobus) {
+		netdev_err(tc6->netdev, "MDIO bus alloc failed\n");
+		return -ENOMEM;
+	}
+
+	tc6->mdiobus->priv = tc6;
+	tc6->mdiobus->read = oa_tc6_mdiobus_read;
+	tc6->mdiobus->write = oa_tc6_mdiobus_write;
+	/* OPEN Alliance 10BASE-T1x compliance MAC-PHYs will have both C22 and
+	 * C45 registers space. If the PHY is discovered via C22 bus protocol it
+	 * assumes it uses C22 protocol and always uses C22 registers indirect
 	 * access to access C45 registers. This is because, we don't have a
 	 * clean separation between C22/C45 register space and C22/C45 MDIO bus
 	 * protocols. Resulting, PHY C45 registers direct access can't be used
@@ -605,6 +1544,9 @@ static int oa_tc6_sw_reset_macphy(struct oa_tc6 *tc6)
 	if (ret)
 		return ret;
 
+	/* All the registers are back at their reset values */
+	oa_tc6_reg_cache_drop(tc6);
+
 	/* Poll for soft reset complete for every 1ms until 1s timeout */
 	ret = readx_poll_timeout(oa_tc6_read_status0, tc6, regval,
 				 regval & STATUS0_RESETC,
@@ -617,152 +1559,434 @@ static int oa_tc6_sw_reset_macphy(struct oa_tc6 *tc6)
 	return oa_tc6_write_register(tc6, OA_TC6_REG_STATUS0, regval);
 }
 
-static int oa_tc6_unmask_macphy_error_interrupts(struct oa_tc6 *tc6)
+static int oa_tc6_unmask_macphy_interrupts(struct oa_tc6 *tc6)
 {
-	u32 regval;
-	int ret;
+	/* Besides the errors, the capture of a tx timestamp is signalled */
+	return oa_tc6_update_register(tc6, OA_TC6_REG_INT_MASK0,
+				      INT_MASK0_TTSCAA_MASK |
+				      INT_MASK0_TX_PROTOCOL_ERR_MASK |
+				      INT_MASK0_RX_BUFFER_OVERFLOW_ERR_MASK |
+				      INT_MASK0_LOSS_OF_FRAME_ERR_MASK |
+				      INT_MASK0_HEADER_ERR_MASK, 0);
+}
 
-	ret = oa_tc6_read_register(tc6, OA_TC6_REG_INT_MASK0, &regval);
-	if (ret)
-		return ret;
+static int oa_tc6_enable_frame_tstamps(struct oa_tc6 *tc6, bool enable)
+{
+	/* The rx timestamps come inline in 64 bit format */
+	return oa_tc6_update_register(tc6, OA_TC6_REG_CONFIG0,
+				      CONFIG0_FTSE | CONFIG0_FTSS,
+				      enable ? CONFIG0_FTSE | CONFIG0_FTSS : 0);
+}
 
-	regval &= ~(INT_MASK0_TX_PROTOCOL_ERR_MASK |
-		    INT_MASK0_RX_BUFFER_OVERFLOW_ERR_MASK |
-		    INT_MASK0_LOSS_OF_FRAME_ERR_MASK |
-		    INT_MASK0_HEADER_ERR_MASK);
+static int oa_tc6_enable_data_transfer(struct oa_tc6 *tc6)
+{
+	/* Enable configuration synchronization for data transfer */
+	return oa_tc6_update_register(tc6, OA_TC6_REG_CONFIG0, CONFIG0_SYNC,
+				      CONFIG0_SYNC);
+}
 
-	return oa_tc6_write_register(tc6, OA_TC6_REG_INT_MASK0, regval);
+static u32 oa_tc6_tx_ring_count(struct oa_tc6 *tc6)
+{
+	return READ_ONCE(tc6->tx_ring_head) - READ_ONCE(tc6->tx_ring_tail);
 }
 
-static int oa_tc6_enable_data_transfer(struct oa_tc6 *tc6)
+static void oa_tc6_tx_ring_push(struct oa_tc6 *tc6, struct sk_buff *skb)
 {
-	u32 value;
-	int ret;
+	u32 head = tc6->tx_ring_head;
 
-	ret = oa_tc6_read_register(tc6, OA_TC6_REG_CONFIG0, &value);
-	if (ret)
-		return ret;
+	/* The caller makes sure that the ring is not full. Publish the skb
+	 * before the new head, pairs with the acquire in the consumer.
+	 */
+	tc6->tx_ring[head & (OA_TC6_TX_RING_SIZE - 1)] = skb;
+	smp_store_release(&tc6->tx_ring_head, head + 1);
+}
 
-	/* Enable configuration synchronization for data transfer */
-	value |= CONFIG0_SYNC;
+static struct sk_buff *oa_tc6_tx_ring_pop(struct oa_tc6 *tc6)
+{
+	u32 tail = tc6->tx_ring_tail;
+	struct sk_buff *skb;
+
+	if (smp_load_acquire(&tc6->tx_ring_head) == tail)
+		return NULL;
+
+	skb = tc6->tx_ring[tail & (OA_TC6_TX_RING_SIZE - 1)];
+
+	/* Release the slot only after the skb has been read from it */
+	smp_store_release(&tc6->tx_ring_tail, tail + 1);
+
+	return skb;
+}
+
+static struct sk_buff *oa_tc6_tx_ring_peek(struct oa_tc6 *tc6)
+{
+	u32 tail = tc6->tx_ring_tail;
+
+	if (smp_load_acquire(&tc6->tx_ring_head) == tail)
+		return NULL;
 
-	return oa_tc6_write_register(tc6, OA_TC6_REG_CONFIG0, value);
+	return tc6->tx_ring[tail & (OA_TC6_TX_RING_SIZE - 1)];
+}
+
+/* Returns the next tx skb to be started, NULL if there is none or if its
+ * launch time is not due yet. A launch time frame is released into the SPI
+ * data transfer the estimated latency ahead of its launch time, which is
+ * compared with the PHC time derived from the system clock. The ETF qdisc
+ * hands the frames over in launch time order, so only the oldest one of the
+ * tx ring is looked at.
+ */
+static struct sk_buff *oa_tc6_next_tx_skb(struct oa_tc6 *tc6)
+{
+	struct sk_buff *skb;
+	s64 offset, now, release;
+
+	if (likely(!tc6->launch_time))
+		return oa_tc6_tx_ring_pop(tc6);
+
+	skb = oa_tc6_tx_ring_peek(tc6);
+	if (!skb)
+		return NULL;
+	if (!skb->tstamp)
+		return oa_tc6_tx_ring_pop(tc6);
+
+	offset = atomic64_read(&tc6->phc_offset_ns);
+	now = ktime_get_real_ns() + offset;
+	release = ktime_to_ns(skb->tstamp) - tc6->launch_latency_ns;
+	if (now < release) {
+		hrtimer_start(&tc6->launch_timer, ns_to_ktime(release - offset),
+			      HRTIMER_MODE_ABS);
+		return NULL;
+	}
+
+	if (now >= ktime_to_ns(skb->tstamp)) {
+		u64_stats_update_begin(&tc6->err_syncp);
+		tc6->err_stats.tx_launch_late++;
+		u64_stats_update_end(&tc6->err_syncp);
+	}
+	tc6->launch_release_ns = now;
+
+	return oa_tc6_tx_ring_pop(tc6);
+}
+
+/* Averages the time from the release of a launch time frame to its tx
+ * timestamp into the latency the frames are released ahead by.
+ */
+static void oa_tc6_update_launch_latency(struct oa_tc6 *tc6, s64 latency)
+{
+	/* A clock step in between doesn't tell anything about the latency */
+	if (latency < 0 || latency > OA_TC6_LAUNCH_LATENCY_MAX_NS)
+		return;
+
+	tc6->launch_latency_ns += (latency - tc6->launch_latency_ns) >>
+				  OA_TC6_LAUNCH_LATENCY_SHIFT;
 }
 
 static void oa_tc6_cleanup_ongoing_rx_skb(struct oa_tc6 *tc6)
 {
 	if (tc6->rx_skb) {
-		tc6->netdev->stats.rx_dropped++;
+		DEV_STATS_INC(tc6->netdev, rx_dropped);
 		kfree_skb(tc6->rx_skb);
 		tc6->rx_skb = NULL;
 	}
+
+	if (tc6->rx_frag_ongoing) {
+		DEV_STATS_INC(tc6->netdev, rx_dropped);
+		tc6->rx_frag_ongoing = false;
+	}
 }
 
 static void oa_tc6_cleanup_ongoing_tx_skb(struct oa_tc6 *tc6)
 {
 	if (tc6->tx_skb) {
-		tc6->netdev->stats.tx_dropped++;
+		DEV_STATS_INC(tc6->netdev, tx_dropped);
+		netdev_completed_queue(tc6->netdev, 1, tc6->tx_skb->len);
 		kfree_skb(tc6->tx_skb);
 		tc6->tx_skb = NULL;
+		tc6->tx_skb_offset = 0;
+		tc6->tx_skb_frag_offset = 0;
+		tc6->tx_skb_frag = 0;
 	}
 }
 
-static int oa_tc6_process_extended_status(struct oa_tc6 *tc6)
+static void oa_tc6_drop_tx_tstamp(struct oa_tc6 *tc6)
 {
-	u32 value;
-	int ret;
+	if (!tc6->tx_tstamp_skb)
+		return;
+
+	u64_stats_update_begin(&tc6->err_syncp);
+	tc6->err_stats.tx_tstamp_lost++;
+	u64_stats_update_end(&tc6->err_syncp);
+	dev_kfree_skb_any(tc6->tx_tstamp_skb);
+	tc6->tx_tstamp_skb = NULL;
+}
 
-	ret = oa_tc6_read_register(tc6, OA_TC6_REG_STATUS0, &value);
-	if (ret) {
-		netdev_err(tc6->netdev, "STATUS0 register read failed: %d\n",
-			   ret);
-		return -ENODEV;
+/* Returns true if the timestamp of the tx frame is to be captured */
+static bool oa_tc6_request_tx_tstamp(struct oa_tc6 *tc6, struct sk_buff *skb)
+{
+	/* Marked by oa_tc6_start_xmit() when the frame was queued */
+	if (likely(!(skb_shinfo(skb)->tx_flags & SKBTX_IN_PROGRESS)) ||
+	    !READ_ONCE(tc6->hwtstamp_tx))
+		return false;
+
+	/* Only the TTSCA registers are used, so the timestamp of one frame
+	 * at a time is captured. A capture that never completed is given up.
+	 */
+	if (tc6->tx_tstamp_skb) {
+		if (time_before(jiffies, tc6->tx_tstamp_start +
+				OA_TC6_TX_TSTAMP_TIMEOUT)) {
+			u64_stats_update_begin(&tc6->err_syncp);
+			tc6->err_stats.tx_tstamp_skipped++;
+			u64_stats_update_end(&tc6->err_syncp);
+			return false;
+		}
+		oa_tc6_drop_tx_tstamp(tc6);
 	}
 
-	/* Clear the error interrupts status */
-	ret = oa_tc6_write_register(tc6, OA_TC6_REG_STATUS0, value);
+	tc6->tx_tstamp_skb = skb_get(skb);
+	tc6->tx_tstamp_start = jiffies;
+	/* The frame was just released by oa_tc6_next_tx_skb() */
+	tc6->tx_tstamp_release_ns = tc6->launch_time && skb->tstamp ?
+				    tc6->launch_release_ns : 0;
+
+	return true;
+}
+
+static void oa_tc6_complete_tx_tstamp(struct oa_tc6 *tc6)
+{
+	struct skb_shared_hwtstamps hwtstamps = {};
+	struct sk_buff *skb = tc6->tx_tstamp_skb;
+	u32 regs[2];
+
+	if (!skb)
+		return;
+
+	if (oa_tc6_data_read_registers(tc6, OA_TC6_REG_TTSCAH, regs,
+				       ARRAY_SIZE(regs))) {
+		oa_tc6_drop_tx_tstamp(tc6);
+		return;
+	}
+
+	tc6->tx_tstamp_skb = NULL;
+	hwtstamps.hwtstamp = ktime_set(regs[0], regs[1]);
+	if (tc6->tx_tstamp_release_ns)
+		oa_tc6_update_launch_latency(tc6,
+					     ktime_to_ns(hwtstamps.hwtstamp) -
+					     tc6->tx_tstamp_release_ns);
+	skb_tstamp_tx(skb, &hwtstamps);
+	dev_kfree_skb_any(skb);
+}
+
+/* Counts a framing error, which is recovered from by resynchronizing the data
+ * path with the MAC-PHY.
+ */
+static int oa_tc6_framing_error(struct oa_tc6 *tc6, u64 *counter,
+				const char *error)
+{
+	u64_stats_update_begin(&tc6->err_syncp);
+	(*counter)++;
+	u64_stats_update_end(&tc6->err_syncp);
+
+	net_err_ratelimited("%s: %s, resynchronizing\n", tc6->netdev->name,
+			    error);
+
+	return -EPROTO;
+}
+
+/* Reads the registers of a MAC-PHY specific event in one burst and hands
+ * them to the MAC-PHY driver.
+ */
+static void oa_tc6_capture_event(struct oa_tc6 *tc6, u32 status1)
+{
+	struct oa_tc6_event_capture *capture = tc6->event_capture;
+	u32 regs[OA_TC6_EVENT_CAPTURE_MAX_REGS];
+	int ret;
+
+	if (!capture || !(status1 & capture->status1))
+		return;
+
+	ret = oa_tc6_data_read_registers(tc6, capture->address, regs,
+					 capture->length);
+	if (ret) {
+		net_err_ratelimited("%s: Event capture read failed: %d\n",
+				    tc6->netdev->name, ret);
+		return;
+	}
+
+	capture->handler(capture, status1, regs);
+}
+
+static int oa_tc6_process_extended_status(struct oa_tc6 *tc6)
+{
+	struct oa_tc6_error_stats *stats = &tc6->err_stats;
+	u32 status[2];
+	u32 value;
+	int ret;
+
+	/* STATUS0 and STATUS1 are read and cleared with one burst each */
+	ret = oa_tc6_data_read_registers(tc6, OA_TC6_REG_STATUS0, status,
+					 ARRAY_SIZE(status));
+	if (ret) {
+		netdev_err(tc6->netdev, "STATUS0 register read failed: %d\n",
+			   ret);
+		return -ENODEV;
+	}
+
+	trace_oa_tc6_ext_status(tc6->netdev, status[0], status[1]);
+
+	/* Clear the error and event interrupts status */
+	ret = oa_tc6_data_write_registers(tc6, OA_TC6_REG_STATUS0, status,
+					  ARRAY_SIZE(status));
 	if (ret) {
 		netdev_err(tc6->netdev, "STATUS0 register write failed: %d\n",
 			   ret);
 		return -ENODEV;
 	}
 
+	value = status[0];
+	u64_stats_update_begin(&tc6->data_syncp);
+	tc6->data_stats.ext_status_reads++;
+	if (FIELD_GET(STATUS0_RX_BUFFER_OVERFLOW_ERROR, value))
+		tc6->data_stats.rx_buf_overflows++;
+	u64_stats_update_end(&tc6->data_syncp);
+
+	if (status[1])
+		oa_tc6_capture_event(tc6, status[1]);
+
+	if (FIELD_GET(STATUS0_TTSCAA, value))
+		oa_tc6_complete_tx_tstamp(tc6);
+
 	if (FIELD_GET(STATUS0_RX_BUFFER_OVERFLOW_ERROR, value)) {
 		tc6->rx_buf_overflow = true;
 		oa_tc6_cleanup_ongoing_rx_skb(tc6);
 		net_err_ratelimited("%s: Receive buffer overflow error\n",
 				    tc6->netdev->name);
-		return -EAGAIN;
-	}
-	if (FIELD_GET(STATUS0_TX_PROTOCOL_ERROR, value)) {
-		netdev_err(tc6->netdev, "Transmit protocol error\n");
-		return -ENODEV;
-	}
-	/* TODO: Currently loss of frame and header errors are treated as
-	 * non-recoverable errors. They will be handled in the next version.
-	 */
-	if (FIELD_GET(STATUS0_LOSS_OF_FRAME_ERROR, value)) {
-		netdev_err(tc6->netdev, "Loss of frame error\n");
-		return -ENODEV;
-	}
-	if (FIELD_GET(STATUS0_HEADER_ERROR, value)) {
-		netdev_err(tc6->netdev, "Header error\n");
-		return -ENODEV;
+		ret = -EAGAIN;
 	}
+	if (FIELD_GET(STATUS0_TX_PROTOCOL_ERROR, value))
+		ret = oa_tc6_framing_error(tc6, &stats->tx_protocol_error,
+					   "Transmit protocol error");
+	if (FIELD_GET(STATUS0_LOSS_OF_FRAME_ERROR, value))
+		ret = oa_tc6_framing_error(tc6, &stats->loss_of_frame,
+					   "Loss of frame error");
+	if (FIELD_GET(STATUS0_HEADER_ERROR, value))
+		ret = oa_tc6_framing_error(tc6, &stats->header_error,
+					   "Header error");
 
-	return 0;
+	return ret;
 }
 
-static int oa_tc6_process_rx_chunk_footer(struct oa_tc6 *tc6, u32 footer)
+static void oa_tc6_update_buffer_status(struct oa_tc6 *tc6, u32 footer)
 {
-	/* Process rx chunk footer for the following,
-	 * 1. tx credits
-	 * 2. errors if any from MAC-PHY
-	 * 3. receive chunks available
-	 */
 	tc6->tx_credits = FIELD_GET(OA_TC6_DATA_FOOTER_TX_CREDITS, footer);
 	tc6->rx_chunks_available = FIELD_GET(OA_TC6_DATA_FOOTER_RX_CHUNKS_AVAILABLE,
 					     footer);
+}
 
-	if (FIELD_GET(OA_TC6_DATA_FOOTER_EXTENDED_STS, footer)) {
-		int ret = oa_tc6_process_extended_status(tc6);
+static int oa_tc6_process_rx_chunk_footer(struct oa_tc6 *tc6, u32 footer)
+{
+	/* Process exceptional rx chunk footer for errors from MAC-PHY, the tx
+	 * credits and receive chunks available are taken from the last footer
+	 * of the transfer.
+	 */
+	struct oa_tc6_error_stats *stats = &tc6->err_stats;
+	int ret = 0;
 
-		if (ret)
+	if (FIELD_GET(OA_TC6_DATA_FOOTER_EXTENDED_STS, footer)) {
+		ret = oa_tc6_process_extended_status(tc6);
+		if (ret && ret != -EAGAIN && ret != -EPROTO)
 			return ret;
 	}
 
-	/* TODO: Currently received header bad and configuration unsync errors
-	 * are treated as non-recoverable errors. They will be handled in the
-	 * next version.
-	 */
-	if (FIELD_GET(OA_TC6_DATA_FOOTER_RXD_HEADER_BAD, footer)) {
-		netdev_err(tc6->netdev, "Rxd header bad error\n");
-		return -ENODEV;
-	}
+	if (FIELD_GET(OA_TC6_DATA_FOOTER_RXD_HEADER_BAD, footer))
+		ret = oa_tc6_framing_error(tc6, &stats->rxd_header_bad,
+					   "Rxd header bad error");
 
 	if (!FIELD_GET(OA_TC6_DATA_FOOTER_CONFIG_SYNC, footer)) {
-		netdev_err(tc6->netdev, "Config unsync error\n");
-		return -ENODEV;
+		tc6->config_unsync = true;
+		ret = oa_tc6_framing_error(tc6, &stats->config_unsync,
+					   "Config unsync error");
 	}
 
-	return 0;
+	return ret;
 }
 
 static void oa_tc6_submit_rx_skb(struct oa_tc6 *tc6)
 {
+	trace_oa_tc6_rx_frame(tc6->netdev, tc6->rx_skb);
+	if (tc6->rx_tstamp)
+		skb_hwtstamps(tc6->rx_skb)->hwtstamp = tc6->rx_tstamp;
 	tc6->rx_skb->protocol = eth_type_trans(tc6->rx_skb, tc6->netdev);
-	tc6->netdev->stats.rx_packets++;
-	tc6->netdev->stats.rx_bytes += tc6->rx_skb->len;
+	u64_stats_update_begin(&tc6->data_syncp);
+	tc6->data_stats.rx_packets++;
+	tc6->data_stats.rx_bytes += tc6->rx_skb->len;
+	u64_stats_update_end(&tc6->data_syncp);
 
-	if (netif_rx(tc6->rx_skb) == NET_RX_DROP)
-		tc6->netdev->stats.rx_dropped++;
+	/* Frames are collected per SPI data transfer and handed over to NAPI
+	 * in one go once the whole receive buffer is processed.
+	 */
+	__skb_queue_tail(&tc6->rx_skb_list, tc6->rx_skb);
 
 	tc6->rx_skb = NULL;
 }
 
-static void oa_tc6_update_rx_skb(struct oa_tc6 *tc6, u8 *payload, u8 length)
+static void oa_tc6_deliver_rx_skbs(struct oa_tc6 *tc6)
+{
+	struct sk_buff_head drop_list;
+
+	if (skb_queue_empty(&tc6->rx_skb_list))
+		return;
+
+	__skb_queue_head_init(&drop_list);
+
+	spin_lock_bh(&tc6->rx_skb_q.lock);
+	/* Don't let the backlog grow without bound if the stack can't keep up
+	 * with the SPI thread.
+	 */
+	while (skb_queue_len(&tc6->rx_skb_q) + skb_queue_len(&tc6->rx_skb_list) >
+	       OA_TC6_RX_SKB_QUEUE_SIZE)
+		__skb_queue_tail(&drop_list,
+				 __skb_dequeue_tail(&tc6->rx_skb_list));
+	skb_queue_splice_tail_init(&tc6->rx_skb_list, &tc6->rx_skb_q);
+	spin_unlock_bh(&tc6->rx_skb_q.lock);
+
+	DEV_STATS_ADD(tc6->netdev, rx_dropped, skb_queue_len(&drop_list));
+	__skb_queue_purge(&drop_list);
+
+	/* Raise the NET_RX softirq with bottom halves disabled so that it runs
+	 * right away when they are enabled again instead of waking ksoftirqd.
+	 */
+	local_bh_disable();
+	napi_schedule(&tc6->napi);
+	local_bh_enable();
+}
+
+static int oa_tc6_napi_poll(struct napi_struct *napi, int budget)
 {
-	memcpy(skb_put(tc6->rx_skb, length), payload, length);
+	struct oa_tc6 *tc6 = container_of(napi, struct oa_tc6, napi);
+	int work_done = 0;
+
+	if (skb_queue_empty(&tc6->napi_rx_list)) {
+		spin_lock(&tc6->rx_skb_q.lock);
+		skb_queue_splice_tail_init(&tc6->rx_skb_q, &tc6->napi_rx_list);
+		spin_unlock(&tc6->rx_skb_q.lock);
+	}
+
+	/* GRO batches the frames it can't merge and passes them to the stack
+	 * as a list when the poll completes.
+	 */
+	while (work_done < budget) {
+		struct sk_buff *skb = __skb_dequeue(&tc6->napi_rx_list);
+
+		if (!skb)
+			break;
+
+		napi_gro_receive(napi, skb);
+		work_done++;
+	}
+
+	if (work_done < budget)
+		napi_complete_done(napi, work_done);
+
+	return work_done;
 }
 
 static int oa_tc6_allocate_rx_skb(struct oa_tc6 *tc6)
@@ -770,7 +1994,7 @@ static int oa_tc6_allocate_rx_skb(struct oa_tc6 *tc6)
 	tc6->rx_skb = netdev_alloc_skb(tc6->netdev, tc6->netdev->mtu + ETH_HLEN +
 				       ETH_FCS_LEN + NET_IP_ALIGN);
 	if (!tc6->rx_skb) {
-		tc6->netdev->stats.rx_dropped++;
+		DEV_STATS_INC(tc6->netdev, rx_dropped);
 		return -ENOMEM;
 	}
 	skb_reserve(tc6->rx_skb, NET_IP_ALIGN);
@@ -778,40 +2002,109 @@ static int oa_tc6_allocate_rx_skb(struct oa_tc6 *tc6)
 	return 0;
 }
 
-static int oa_tc6_prcs_complete_rx_frame(struct oa_tc6 *tc6, u8 *payload,
-					 u16 size)
+static void oa_tc6_update_rx_skb(struct oa_tc6 *tc6, u8 *payload, u8 length)
 {
-	int ret;
+	u8 *frag_end;
 
-	ret = oa_tc6_allocate_rx_skb(tc6);
-	if (ret)
-		return ret;
+	/* Frame continued from a previous SPI data transfer */
+	if (tc6->rx_skb) {
+		memcpy(skb_put(tc6->rx_skb, length), payload, length);
+		return;
+	}
 
-	oa_tc6_update_rx_skb(tc6, payload, size);
+	if (!tc6->rx_frag_ongoing)
+		return;
 
-	oa_tc6_submit_rx_skb(tc6);
+	/* Move the payload right behind the already received part of the
+	 * frame, squeezing out the footer of the previous chunk. Each payload
+	 * byte is moved at most once.
+	 */
+	frag_end = tc6->rx_data_buf->rx_buf + tc6->rx_frag_offset +
+		   tc6->rx_frag_len;
+	if (frag_end != payload)
+		memmove(frag_end, payload, length);
+	tc6->rx_frag_len += length;
+}
 
-	return 0;
+static void oa_tc6_build_rx_frag_skb(struct oa_tc6 *tc6)
+{
+	struct oa_tc6_spi_data_buf *buf = tc6->rx_data_buf;
+	u8 *data = buf->rx_buf + tc6->rx_frag_offset;
+	u16 length = tc6->rx_frag_len;
+	u16 headlen = length;
+	struct sk_buff *skb;
+
+	tc6->rx_frag_ongoing = false;
+
+	/* Receive buffer is not backed by the page pool, copy the frame */
+	if (!buf->rx_page) {
+		if (oa_tc6_allocate_rx_skb(tc6))
+			return;
+		skb_put_data(tc6->rx_skb, data, length);
+		return;
+	}
+
+	skb = netdev_alloc_skb_ip_align(tc6->netdev, OA_TC6_RX_SKB_HDR_SIZE);
+	if (!skb) {
+		DEV_STATS_INC(tc6->netdev, rx_dropped);
+		return;
+	}
+
+	/* Only the protocol headers are copied to the linear area, the rest
+	 * of the frame is attached as a page pool fragment.
+	 */
+	if (length > OA_TC6_RX_SKB_HDR_SIZE)
+		headlen = eth_get_headlen(tc6->netdev, data,
+					  OA_TC6_RX_SKB_HDR_SIZE);
+	skb_put_data(skb, data, headlen);
+
+	if (length > headlen) {
+		skb_add_rx_frag(skb, 0, buf->rx_page,
+				data + headlen - (u8 *)page_address(buf->rx_page),
+				length - headlen,
+				DIV_ROUND_UP(length, OA_TC6_CHUNK_PAYLOAD_SIZE) *
+				OA_TC6_CHUNK_SIZE);
+		skb_mark_for_recycle(skb);
+		buf->rx_page_frags++;
+	}
+
+	tc6->rx_skb = skb;
 }
 
-static int oa_tc6_prcs_rx_frame_start(struct oa_tc6 *tc6, u8 *payload, u16 size)
+static void oa_tc6_prcs_rx_frame_start(struct oa_tc6 *tc6, u8 *payload,
+				       u16 size, ktime_t tstamp)
 {
-	int ret;
+	/* Drop the previous frame if its end was never received */
+	oa_tc6_cleanup_ongoing_rx_skb(tc6);
 
-	ret = oa_tc6_allocate_rx_skb(tc6);
-	if (ret)
-		return ret;
+	tc6->rx_tstamp = tstamp;
+	tc6->rx_frag_offset = payload - (u8 *)tc6->rx_data_buf->rx_buf;
+	tc6->rx_frag_len = size;
+	tc6->rx_frag_ongoing = true;
+}
 
-	oa_tc6_update_rx_skb(tc6, payload, size);
+static void oa_tc6_complete_rx_frame(struct oa_tc6 *tc6)
+{
+	if (tc6->rx_frag_ongoing)
+		oa_tc6_build_rx_frag_skb(tc6);
 
-	return 0;
+	if (tc6->rx_skb)
+		oa_tc6_submit_rx_skb(tc6);
+}
+
+static void oa_tc6_prcs_complete_rx_frame(struct oa_tc6 *tc6, u8 *payload,
+					  u16 size, ktime_t tstamp)
+{
+	oa_tc6_prcs_rx_frame_start(tc6, payload, size, tstamp);
+
+	oa_tc6_complete_rx_frame(tc6);
 }
 
 static void oa_tc6_prcs_rx_frame_end(struct oa_tc6 *tc6, u8 *payload, u16 size)
 {
 	oa_tc6_update_rx_skb(tc6, payload, size);
 
-	oa_tc6_submit_rx_skb(tc6);
+	oa_tc6_complete_rx_frame(tc6);
 }
 
 static void oa_tc6_prcs_ongoing_rx_frame(struct oa_tc6 *tc6, u8 *payload,
@@ -820,6 +2113,34 @@ static void oa_tc6_prcs_ongoing_rx_frame(struct oa_tc6 *tc6, u8 *payload,
 	oa_tc6_update_rx_skb(tc6, payload, OA_TC6_CHUNK_PAYLOAD_SIZE);
 }
 
+/* Returns the timestamp the MAC-PHY put in front of the rx frame, 0 if it is
+ * not to be reported.
+ */
+static ktime_t oa_tc6_get_rx_tstamp(struct oa_tc6 *tc6, __be32 *tstamp,
+				    u32 footer)
+{
+	u32 sec = be32_to_cpu(tstamp[0]);
+	u32 nsec = be32_to_cpu(tstamp[1]);
+
+	/* The parity bit is set if the timestamp has an odd number of set
+	 * bits.
+	 */
+	if (FIELD_GET(OA_TC6_DATA_FOOTER_RX_TIMESTAMP_PARITY, footer) !=
+	    (hweight32(sec ^ nsec) & 1)) {
+		u64_stats_update_begin(&tc6->err_syncp);
+		tc6->err_stats.rx_tstamp_parity++;
+		u64_stats_update_end(&tc6->err_syncp);
+		net_err_ratelimited("%s: Rx timestamp parity error\n",
+				    tc6->netdev->name);
+		return 0;
+	}
+
+	if (!READ_ONCE(tc6->hwtstamp_rx))
+		return 0;
+
+	return ktime_set(sec, nsec);
+}
+
 static int oa_tc6_prcs_rx_chunk_payload(struct oa_tc6 *tc6, u8 *payload,
 					u32 footer)
 {
@@ -829,6 +2150,7 @@ static int oa_tc6_prcs_rx_chunk_payload(struct oa_tc6 *tc6, u8 *payload,
 				       footer);
 	bool start_valid = FIELD_GET(OA_TC6_DATA_FOOTER_START_VALID, footer);
 	bool end_valid = FIELD_GET(OA_TC6_DATA_FOOTER_END_VALID, footer);
+	ktime_t tstamp = 0;
 	u16 size;
 
 	/* Restart the new rx frame after receiving rx buffer overflow error */
@@ -838,18 +2160,46 @@ static int oa_tc6_prcs_rx_chunk_payload(struct oa_tc6 *tc6, u8 *payload,
 	if (tc6->rx_buf_overflow)
 		return 0;
 
+	/* The timestamp of the frame starting in this chunk precedes its data
+	 * and is stripped right away, without a register read.
+	 */
+	if (start_valid &&
+	    FIELD_GET(OA_TC6_DATA_FOOTER_RX_TIMESTAMP_ADDED, footer)) {
+		/* Timestamped frames are expected to start early enough in
+		 * the chunk to carry the timestamp, which holds with ZARFE.
+		 * A frame whose timestamp straddles chunks is dropped.
+		 */
+		if (start_byte_offset + OA_TC6_RX_TSTAMP_SIZE >
+		    OA_TC6_CHUNK_PAYLOAD_SIZE) {
+			if (end_valid && (tc6->rx_skb || tc6->rx_frag_ongoing))
+				oa_tc6_prcs_rx_frame_end(tc6, payload,
+							 end_byte_offset + 1);
+			oa_tc6_cleanup_ongoing_rx_skb(tc6);
+			DEV_STATS_INC(tc6->netdev, rx_errors);
+			tc6->rx_buf_overflow = true;
+			return 0;
+		}
+
+		tstamp = oa_tc6_get_rx_tstamp(tc6,
+					      (__be32 *)&payload[start_byte_offset],
+					      footer);
+		start_byte_offset += OA_TC6_RX_TSTAMP_SIZE;
+	}
+
 	/* Process the chunk with complete rx frame */
 	if (start_valid && end_valid && start_byte_offset < end_byte_offset) {
 		size = end_byte_offset + 1 - start_byte_offset;
-		return oa_tc6_prcs_complete_rx_frame(tc6, &payload[start_byte_offset],
-						     size);
+		oa_tc6_prcs_complete_rx_frame(tc6, &payload[start_byte_offset],
+					      size, tstamp);
+		return 0;
 	}
 
 	/* Process the chunk with only rx frame start */
 	if (start_valid && !end_valid) {
 		size = OA_TC6_CHUNK_PAYLOAD_SIZE - start_byte_offset;
-		return oa_tc6_prcs_rx_frame_start(tc6, &payload[start_byte_offset],
-						  size);
+		oa_tc6_prcs_rx_frame_start(tc6, &payload[start_byte_offset],
+					   size, tstamp);
+		return 0;
 	}
 
 	/* Process the chunk with only rx frame end */
@@ -865,13 +2215,14 @@ static int oa_tc6_prcs_rx_chunk_payload(struct oa_tc6 *tc6, u8 *payload,
 		 * possibility of getting an end valid of a previously
 		 * incomplete rx frame along with the new rx frame start valid.
 		 */
-		if (tc6->rx_skb) {
+		if (tc6->rx_skb || tc6->rx_frag_ongoing) {
 			size = end_byte_offset + 1;
 			oa_tc6_prcs_rx_frame_end(tc6, payload, size);
 		}
 		size = OA_TC6_CHUNK_PAYLOAD_SIZE - start_byte_offset;
-		return oa_tc6_prcs_rx_frame_start(tc6, &payload[start_byte_offset],
-						  size);
+		oa_tc6_prcs_rx_frame_start(tc6, &payload[start_byte_offset],
+					   size, tstamp);
+		return 0;
 	}
 
 	/* Process the chunk with ongoing rx frame data */
@@ -880,38 +2231,101 @@ static int oa_tc6_prcs_rx_chunk_payload(struct oa_tc6 *tc6, u8 *payload,
 	return 0;
 }
 
-static u32 oa_tc6_get_rx_chunk_footer(struct oa_tc6 *tc6, u16 footer_offset)
+static void oa_tc6_get_spi_data_rx_buf(struct oa_tc6 *tc6,
+				       struct oa_tc6_spi_data_buf *buf)
+{
+	/* Every SPI data transfer receives into a fresh page pool page as the
+	 * received frames are handed to the stack as fragments of it. Fall
+	 * back to the copying receive buffer under memory pressure.
+	 */
+	buf->rx_page = page_pool_dev_alloc_pages(tc6->page_pool);
+	if (!buf->rx_page) {
+		buf->rx_buf = buf->rx_fallback_buf;
+		return;
+	}
+
+	page_pool_fragment_page(buf->rx_page, 1);
+	buf->rx_page_frags = 0;
+	buf->rx_buf = page_address(buf->rx_page);
+}
+
+static void oa_tc6_put_spi_data_rx_buf(struct oa_tc6 *tc6,
+				       struct oa_tc6_spi_data_buf *buf)
 {
-	u8 *rx_buf = tc6->spi_data_rx_buf;
-	__be32 footer;
+	u8 *data = buf->rx_buf + tc6->rx_frag_offset;
+
+	/* A frame continuing in the next SPI data transfer can't stay in the
+	 * current receive buffer, so move the part received so far to an skb.
+	 */
+	if (tc6->rx_frag_ongoing) {
+		tc6->rx_frag_ongoing = false;
+		if (!oa_tc6_allocate_rx_skb(tc6))
+			skb_put_data(tc6->rx_skb, data, tc6->rx_frag_len);
+	}
 
-	footer = *((__be32 *)&rx_buf[footer_offset]);
+	if (!buf->rx_page)
+		return;
+
+	/* Hand over one page reference per fragment to the skbs, the page
+	 * goes back to the pool when the last of them is freed.
+	 */
+	if (buf->rx_page_frags)
+		page_pool_fragment_page(buf->rx_page, buf->rx_page_frags);
+	else
+		page_pool_put_full_page(tc6->page_pool, buf->rx_page, false);
 
-	return be32_to_cpu(footer);
+	buf->rx_page = NULL;
 }
 
 static int oa_tc6_process_spi_data_rx_buf(struct oa_tc6 *tc6, u16 length)
 {
+	struct oa_tc6_rx_footers *footers = &tc6->rx_footers;
 	u16 no_of_rx_chunks = length / OA_TC6_CHUNK_SIZE;
+	u8 *rx_buf = tc6->rx_data_buf->rx_buf;
+	u64 chunks, sane;
 	u32 footer;
 	int ret;
+	int i;
 
-	/* All the rx chunks in the receive SPI data buffer are examined here */
-	for (int i = 0; i < no_of_rx_chunks; i++) {
-		/* Last 4 bytes in each received chunk consist footer info */
-		footer = oa_tc6_get_rx_chunk_footer(tc6, i * OA_TC6_CHUNK_SIZE +
-						    OA_TC6_CHUNK_PAYLOAD_SIZE);
+	/* All the footers of the receive SPI data buffer are decoded in one
+	 * pass, only the chunks with valid data or an exceptional footer are
+	 * examined one by one.
+	 */
+	oa_tc6_classify_footers(rx_buf, no_of_rx_chunks, footers);
 
-		ret = oa_tc6_process_rx_chunk_footer(tc6, footer);
-		if (ret)
-			return ret;
+	chunks = footers->data_valid | footers->exceptions;
+	while (chunks) {
+		i = __ffs64(chunks);
+		chunks &= chunks - 1;
+		footer = footers->footer[i];
+
+		/* Nothing in a corrupted footer can be trusted, the rx frame
+		 * it belongs to is dropped.
+		 */
+		if (footers->bad_parity & BIT_ULL(i)) {
+			u64_stats_update_begin(&tc6->err_syncp);
+			tc6->err_stats.footer_parity++;
+			u64_stats_update_end(&tc6->err_syncp);
+			DEV_STATS_INC(tc6->netdev, rx_errors);
+			tc6->rx_buf_overflow = true;
+			oa_tc6_cleanup_ongoing_rx_skb(tc6);
+			net_err_ratelimited("%s: Footer parity error\n",
+					    tc6->netdev->name);
+			continue;
+		}
+
+		if (footers->exceptions & BIT_ULL(i)) {
+			ret = oa_tc6_process_rx_chunk_footer(tc6, footer);
+			if (ret)
+				return ret;
+		}
 
 		/* If there is a data valid chunks then process it for the
 		 * information needed to determine the validity and the location
 		 * of the receive frame data.
 		 */
 		if (FIELD_GET(OA_TC6_DATA_FOOTER_DATA_VALID, footer)) {
-			u8 *payload = tc6->spi_data_rx_buf + i * OA_TC6_CHUNK_SIZE;
+			u8 *payload = rx_buf + i * OA_TC6_CHUNK_SIZE;
 
 			ret = oa_tc6_prcs_rx_chunk_payload(tc6, payload, footer);
 			if (ret)
@@ -919,269 +2333,1802 @@ static int oa_tc6_process_spi_data_rx_buf(struct oa_tc6 *tc6, u16 length)
 		}
 	}
 
+	/* The tx credits and rx chunks available of the last sane footer are
+	 * the current ones.
+	 */
+	sane = ~footers->bad_parity;
+	if (no_of_rx_chunks < 64)
+		sane &= BIT_ULL(no_of_rx_chunks) - 1;
+	if (sane)
+		oa_tc6_update_buffer_status(tc6, footers->footer[fls64(sane) - 1]);
+
 	return 0;
 }
 
-static __be32 oa_tc6_prepare_data_header(bool data_valid, bool start_valid,
-					 bool end_valid, u8 end_byte_offset)
+static u8 *oa_tc6_get_tx_skb_piece(struct oa_tc6 *tc6, u16 *length)
 {
-	u32 header = FIELD_PREP(OA_TC6_DATA_HEADER_DATA_NOT_CTRL,
-				OA_TC6_DATA_HEADER) |
-		     FIELD_PREP(OA_TC6_DATA_HEADER_DATA_VALID, data_valid) |
-		     FIELD_PREP(OA_TC6_DATA_HEADER_START_VALID, start_valid) |
-		     FIELD_PREP(OA_TC6_DATA_HEADER_END_VALID, end_valid) |
-		     FIELD_PREP(OA_TC6_DATA_HEADER_END_BYTE_OFFSET,
-				end_byte_offset);
+	struct sk_buff *skb = tc6->tx_skb;
+	u16 avail;
+	u8 *data;
+
+	/* Returns the next physically contiguous piece of at most @length
+	 * bytes from the tx skb and advances the fragment cursor past it.
+	 * Fragments are never in highmem as NETIF_F_HIGHDMA is not
+	 * advertised.
+	 */
+	if (!tc6->tx_skb_frag) {
+		avail = skb_headlen(skb) - tc6->tx_skb_frag_offset;
+		data = skb->data + tc6->tx_skb_frag_offset;
+	} else {
+		skb_frag_t *frag = &skb_shinfo(skb)->frags[tc6->tx_skb_frag - 1];
 
-	header |= FIELD_PREP(OA_TC6_DATA_HEADER_PARITY,
-			     oa_tc6_get_parity(header));
+		avail = skb_frag_size(frag) - tc6->tx_skb_frag_offset;
+		data = skb_frag_address(frag) + tc6->tx_skb_frag_offset;
+	}
 
-	return cpu_to_be32(header);
+	if (*length < avail) {
+		tc6->tx_skb_frag_offset += *length;
+		return data;
+	}
+
+	*length = avail;
+	tc6->tx_skb_frag_offset = 0;
+	tc6->tx_skb_frag++;
+
+	return data;
+}
+
+static void oa_tc6_copy_tx_skb_data(struct oa_tc6 *tc6, u8 *buf, u16 length)
+{
+	/* A chunk payload may straddle the linear part and any number of page
+	 * fragments of the tx skb.
+	 */
+	while (length) {
+		u16 piece = length;
+		u8 *data = oa_tc6_get_tx_skb_piece(tc6, &piece);
+
+		memcpy(buf, data, piece);
+		buf += piece;
+		length -= piece;
+	}
+}
+
+static void oa_tc6_add_spi_data_xfer(struct oa_tc6 *tc6, const void *tx_buf,
+				     u16 length)
+{
+	struct oa_tc6_spi_data_buf *buf = tc6->tx_data_buf;
+	struct spi_transfer *xfer;
+
+	/* Extend the previous segment if the tx data follows on directly.
+	 * Chunk headers live in their chunk slot in the tx buffer, so runs
+	 * of empty or bounced chunks end up in a single segment.
+	 */
+	if (buf->xfer_count) {
+		xfer = &buf->xfers[buf->xfer_count - 1];
+		if ((!xfer->tx_buf && !tx_buf) ||
+		    (xfer->tx_buf && tx_buf && xfer->tx_buf + xfer->len == tx_buf)) {
+			xfer->len += length;
+			return;
+		}
+	}
+
+	xfer = &buf->xfers[buf->xfer_count++];
+	memset(xfer, 0, sizeof(*xfer));
+	xfer->tx_buf = tx_buf;
+	xfer->len = length;
+}
+
+static void oa_tc6_add_tx_skb_zc_payload(struct oa_tc6 *tc6, __be32 *tx_buf,
+					 u8 offset, u16 length)
+{
+	u8 *payload = (u8 *)(tx_buf + 1) + offset;
+	u16 piece = length;
+	u8 *data;
+
+	data = oa_tc6_get_tx_skb_piece(tc6, &piece);
+
+	/* Payload straddling skb fragments is bounced through the chunk slot
+	 * to bound the number of segments per chunk.
+	 */
+	if (piece < length) {
+		memcpy(payload, data, piece);
+		oa_tc6_copy_tx_skb_data(tc6, payload + piece, length - piece);
+		oa_tc6_add_spi_data_xfer(tc6, payload, length);
+		return;
+	}
+
+	oa_tc6_add_spi_data_xfer(tc6, data, length);
+}
+
+static void oa_tc6_add_tx_zc_padding(struct oa_tc6 *tc6, __be32 *tx_buf,
+				     u8 from, u8 to)
+{
+	/* The padding is sent from the chunk slot, so it extends a bounced
+	 * payload and gets extended by the header of the next chunk.
+	 */
+	if (to > from)
+		oa_tc6_add_spi_data_xfer(tc6, (u8 *)(tx_buf + 1) + from,
+					 to - from);
+}
+
+static void oa_tc6_add_tx_skb_payload(struct oa_tc6 *tc6, __be32 *tx_buf,
+				      u8 offset, u16 length)
+{
+	/* Copy the tx skb data to the tx chunk payload buffer or let the SPI
+	 * controller gather it from the skb in zero-copy mode.
+	 */
+	if (tc6->tx_data_buf->zc)
+		oa_tc6_add_tx_skb_zc_payload(tc6, tx_buf, offset, length);
+	else
+		oa_tc6_copy_tx_skb_data(tc6, (u8 *)(tx_buf + 1) + offset,
+					length);
+	tc6->tx_skb_offset += length;
+}
+
+static void oa_tc6_complete_tx_skb(struct oa_tc6 *tc6)
+{
+	struct oa_tc6_spi_data_buf *buf = tc6->tx_data_buf;
+
+	tc6->tx_skb_offset = 0;
+	tc6->tx_skb_frag_offset = 0;
+	tc6->tx_skb_frag = 0;
+	trace_oa_tc6_tx_frame_end(tc6->netdev, tc6->tx_skb);
+	u64_stats_update_begin(&tc6->data_syncp);
+	tc6->data_stats.tx_packets++;
+	tc6->data_stats.tx_bytes += tc6->tx_skb->len;
+	u64_stats_update_end(&tc6->data_syncp);
+	tc6->tx_completed_bytes += tc6->tx_skb->len;
+	tc6->tx_completed_pkts++;
+	/* Zero-copy tx skb is released when the SPI transfer is done */
+	if (buf->zc)
+		__skb_queue_tail(&buf->tx_done_list, tc6->tx_skb);
+	else
+		kfree_skb(tc6->tx_skb);
+	tc6->tx_skb = NULL;
+}
+
+/* A chunk carries at most one frame start and one frame end, and a frame
+ * starting behind the end of the previous one begins on a word boundary. So
+ * the next tx frame can be started in the rest of the chunk if the frame
+ * ending in it started in an earlier chunk, and if the next frame doesn't end
+ * in it as well. Returns the start word offset of the next frame, 0 if it
+ * isn't started in this chunk.
+ */
+static u8 oa_tc6_pack_tx_skb(struct oa_tc6 *tc6, __be32 *tx_buf, u8 *used)
+{
+	u8 start_word_offset = DIV_ROUND_UP(*used, sizeof(u32));
+	u8 start = start_word_offset * sizeof(u32);
+	u16 length = OA_TC6_CHUNK_PAYLOAD_SIZE - start;
+
+	if (start_word_offset > FIELD_MAX(OA_TC6_DATA_HEADER_START_WORD_OFFSET))
+		return 0;
+
+	tc6->tx_skb = oa_tc6_next_tx_skb(tc6);
+	if (!tc6->tx_skb || tc6->tx_skb->len <= length)
+		return 0;
+
+	if (tc6->tx_data_buf->zc)
+		oa_tc6_add_tx_zc_padding(tc6, tx_buf, *used, start);
+	oa_tc6_add_tx_skb_payload(tc6, tx_buf, start, length);
+	*used = OA_TC6_CHUNK_PAYLOAD_SIZE;
+
+	return start_word_offset;
 }
 
 static void oa_tc6_add_tx_skb_to_spi_buf(struct oa_tc6 *tc6)
 {
 	enum oa_tc6_data_start_valid_info start_valid = OA_TC6_DATA_START_INVALID;
 	enum oa_tc6_data_end_valid_info end_valid = OA_TC6_DATA_END_INVALID;
-	__be32 *tx_buf = tc6->spi_data_tx_buf + tc6->spi_data_tx_buf_offset;
+	struct oa_tc6_spi_data_buf *buf = tc6->tx_data_buf;
+	__be32 *tx_buf = buf->tx_buf + buf->tx_buf_offset;
 	u16 remaining_length = tc6->tx_skb->len - tc6->tx_skb_offset;
-	u8 *tx_skb_data = tc6->tx_skb->data + tc6->tx_skb_offset;
+	u8 start_word_offset = 0;
 	u8 end_byte_offset = 0;
-	u16 length_to_copy;
+	bool tstamp = false;
+	u8 used;
 
 	/* Set start valid if the current tx chunk contains the start of the tx
 	 * ethernet frame.
 	 */
-	if (!tc6->tx_skb_offset)
+	if (!tc6->tx_skb_offset) {
 		start_valid = OA_TC6_DATA_START_VALID;
+		tstamp = oa_tc6_request_tx_tstamp(tc6, tc6->tx_skb);
+		trace_oa_tc6_tx_frame_start(tc6->netdev, tc6->tx_skb);
+	}
 
 	/* If the remaining tx skb length is more than the chunk payload size of
 	 * 64 bytes then copy only 64 bytes and leave the ongoing tx skb for
 	 * next tx chunk.
 	 */
-	length_to_copy = min_t(u16, remaining_length, OA_TC6_CHUNK_PAYLOAD_SIZE);
+	used = min_t(u16, remaining_length, OA_TC6_CHUNK_PAYLOAD_SIZE);
 
-	/* Copy the tx skb data to the tx chunk payload buffer */
-	memcpy(tx_buf + 1, tx_skb_data, length_to_copy);
-	tc6->tx_skb_offset += length_to_copy;
+	if (buf->zc)
+		oa_tc6_add_spi_data_xfer(tc6, tx_buf, OA_TC6_DATA_HEADER_SIZE);
+	oa_tc6_add_tx_skb_payload(tc6, tx_buf, 0, used);
 
 	/* Set end valid if the current tx chunk contains the end of the tx
-	 * ethernet frame.
+	 * ethernet frame, and start the next one behind it if possible.
 	 */
 	if (tc6->tx_skb->len == tc6->tx_skb_offset) {
 		end_valid = OA_TC6_DATA_END_VALID;
-		end_byte_offset = length_to_copy - 1;
-		tc6->tx_skb_offset = 0;
-		tc6->netdev->stats.tx_bytes += tc6->tx_skb->len;
-		tc6->netdev->stats.tx_packets++;
-		kfree_skb(tc6->tx_skb);
-		tc6->tx_skb = NULL;
+		end_byte_offset = used - 1;
+		oa_tc6_complete_tx_skb(tc6);
+		if (!start_valid && buf->tx_packing)
+			start_word_offset = oa_tc6_pack_tx_skb(tc6, tx_buf,
+							       &used);
+		if (start_word_offset) {
+			tstamp = oa_tc6_request_tx_tstamp(tc6, tc6->tx_skb);
+			trace_oa_tc6_tx_frame_start(tc6->netdev, tc6->tx_skb);
+		}
+	}
+
+	if (buf->zc)
+		oa_tc6_add_tx_zc_padding(tc6, tx_buf, used,
+					 OA_TC6_CHUNK_PAYLOAD_SIZE);
+
+	if (start_word_offset)
+		*tx_buf = oa_tc6_packed_data_header(start_word_offset,
+						    end_byte_offset);
+	else
+		*tx_buf = oa_tc6_data_header(start_valid, end_valid,
+					     end_byte_offset);
+	if (tstamp)
+		*tx_buf = oa_tc6_tstamp_data_header(*tx_buf);
+	buf->tx_buf_offset += OA_TC6_CHUNK_SIZE;
+}
+
+static u16 oa_tc6_prepare_spi_tx_buf_for_tx_skbs(struct oa_tc6 *tc6,
+						 u16 max_chunks)
+{
+	u16 tx_credits = min(tc6->tx_credits, max_chunks);
+	u16 used_tx_credits;
+
+	if (!tc6->tx_credits) {
+		u64_stats_update_begin(&tc6->data_syncp);
+		tc6->data_stats.tx_credit_stalls++;
+		u64_stats_update_end(&tc6->data_syncp);
+	}
+
+	/* Get tx skbs and convert them into tx chunks based on the tx credits
+	 * available.
+	 */
+	for (used_tx_credits = 0; used_tx_credits < tx_credits;
+	     used_tx_credits++) {
+		if (!tc6->tx_skb)
+			tc6->tx_skb = oa_tc6_next_tx_skb(tc6);
+		if (!tc6->tx_skb)
+			break;
+		oa_tc6_add_tx_skb_to_spi_buf(tc6);
+	}
+
+	tc6->tx_data_buf->tx_chunks = used_tx_credits;
+	tc6->tx_credits -= used_tx_credits;
+
+	/* Report the frames whose last chunk left the tx skb queue to BQL.
+	 * Bottom halves are disabled so that a queue restart runs right away.
+	 */
+	if (tc6->tx_completed_pkts) {
+		local_bh_disable();
+		netdev_completed_queue(tc6->netdev, tc6->tx_completed_pkts,
+				       tc6->tx_completed_bytes);
+		local_bh_enable();
+		tc6->tx_completed_pkts = 0;
+		tc6->tx_completed_bytes = 0;
 	}
 
-	*tx_buf = oa_tc6_prepare_data_header(OA_TC6_DATA_VALID, start_valid,
-					     end_valid, end_byte_offset);
-	tc6->spi_data_tx_buf_offset += OA_TC6_CHUNK_SIZE;
+	return used_tx_credits * OA_TC6_CHUNK_SIZE;
+}
+
+static void oa_tc6_add_empty_chunks_to_spi_buf(struct oa_tc6 *tc6,
+					       u16 needed_empty_chunks)
+{
+	struct oa_tc6_spi_data_buf *buf = tc6->tx_data_buf;
+
+	while (needed_empty_chunks--) {
+		__be32 *tx_buf = buf->tx_buf + buf->tx_buf_offset;
+
+		*tx_buf = oa_tc6_empty_data_header;
+		if (buf->zc)
+			oa_tc6_add_spi_data_xfer(tc6, tx_buf, OA_TC6_CHUNK_SIZE);
+		buf->tx_buf_offset += OA_TC6_CHUNK_SIZE;
+	}
+}
+
+static u16 oa_tc6_prepare_spi_tx_buf_for_rx_chunks(struct oa_tc6 *tc6, u16 len,
+						   u16 max_chunks)
+{
+	u16 rx_chunks = min_t(u16, tc6->rx_chunks_available, max_chunks);
+	u16 tx_chunks = len / OA_TC6_CHUNK_SIZE;
+	u16 needed_empty_chunks;
+
+	/* If there are more chunks to receive than to transmit, we need to add
+	 * enough empty tx chunks to allow the reception of the excess rx
+	 * chunks.
+	 */
+	if (tx_chunks >= rx_chunks)
+		return len;
+
+	needed_empty_chunks = rx_chunks - tx_chunks;
+
+	oa_tc6_add_empty_chunks_to_spi_buf(tc6, needed_empty_chunks);
+
+	return needed_empty_chunks * OA_TC6_CHUNK_SIZE + len;
+}
+
+static u16 oa_tc6_prepare_spi_data_buf(struct oa_tc6 *tc6,
+				       struct oa_tc6_spi_data_buf *buf,
+				       u16 max_chunks, bool in_flight)
+{
+	u16 spi_length = 0;
+
+	tc6->tx_data_buf = buf;
+	buf->tx_buf_offset = 0;
+	buf->tx_chunks = 0;
+	buf->xfer_count = 0;
+	buf->zc = READ_ONCE(tc6->tx_zero_copy);
+	buf->tx_packing = READ_ONCE(tc6->tx_packing);
+
+	if (tc6->tx_skb || oa_tc6_tx_ring_count(tc6))
+		spi_length = oa_tc6_prepare_spi_tx_buf_for_tx_skbs(tc6,
+								   max_chunks);
+
+	if (tc6->rx_chunks_available)
+		spi_length = oa_tc6_prepare_spi_tx_buf_for_rx_chunks(tc6,
+								     spi_length,
+								     max_chunks);
+
+	/* An interrupt only needs a transfer if nothing else is going to read
+	 * a footer. The footers of a transfer still on the bus may predate
+	 * the interrupt, so keep it pending until that one is processed.
+	 */
+	if ((spi_length || !in_flight) &&
+	    test_and_clear_bit(OA_TC6_EVENT_IRQ, &tc6->events)) {
+		if (spi_length == 0) {
+			oa_tc6_add_empty_chunks_to_spi_buf(tc6, 1);
+			spi_length = OA_TC6_CHUNK_SIZE;
+		}
+	}
+
+	/* The chunks of this transfer drain the receive chunks announced so
+	 * far.
+	 */
+	tc6->rx_chunks_available -= min_t(u16, tc6->rx_chunks_available,
+					  spi_length / OA_TC6_CHUNK_SIZE);
+	buf->length = spi_length;
+
+	return spi_length;
+}
+
+static void oa_tc6_spi_data_complete(void *context)
+{
+	struct oa_tc6_spi_data_buf *buf = context;
+
+	complete(&buf->done);
+}
+
+static int oa_tc6_submit_spi_data_buf(struct oa_tc6 *tc6,
+				      struct oa_tc6_spi_data_buf *buf)
+{
+	u8 *rx_buf;
+
+	/* A single chunk, mostly an interrupt acknowledgement, uses the
+	 * message prepared at init time. It receives into the fallback buffer
+	 * as the payload is copied out cheaper than a page is set up for it.
+	 */
+	if (buf->length == OA_TC6_CHUNK_SIZE &&
+	    (!buf->zc || buf->xfer_count == 1)) {
+		buf->rx_page = NULL;
+		buf->rx_buf = buf->rx_fallback_buf;
+		buf->spi_msg = &buf->chunk_msg;
+		goto submit;
+	}
+
+	oa_tc6_get_spi_data_rx_buf(tc6, buf);
+
+	/* In zero-copy mode the tx side of the message gathers chunk headers
+	 * and skb data, the rx side is always one contiguous buffer.
+	 */
+	if (buf->zc) {
+		rx_buf = buf->rx_buf;
+		for (int i = 0; i < buf->xfer_count; i++) {
+			buf->xfers[i].rx_buf = rx_buf;
+			rx_buf += buf->xfers[i].len;
+		}
+		spi_message_init_with_transfers(&buf->zc_msg, buf->xfers,
+						buf->xfer_count);
+		buf->zc_msg.complete = oa_tc6_spi_data_complete;
+		buf->zc_msg.context = buf;
+		buf->spi_msg = &buf->zc_msg;
+	} else {
+		buf->xfer.rx_buf = buf->rx_buf;
+		buf->xfer.len = buf->length;
+		buf->spi_msg = &buf->msg;
+	}
+
+submit:
+	reinit_completion(&buf->done);
+	trace_oa_tc6_spi_xfer_start(tc6->netdev,
+				    buf->length / OA_TC6_CHUNK_SIZE,
+				    buf->tx_chunks, tc6->tx_credits,
+				    tc6->rx_chunks_available);
+
+	return spi_async(tc6->spi, buf->spi_msg);
+}
+
+static int oa_tc6_wait_spi_data_buf(struct oa_tc6 *tc6,
+				    struct oa_tc6_spi_data_buf *buf)
+{
+	wait_for_completion(&buf->done);
+
+	/* The zero-copy tx skbs are not referenced by the bus anymore */
+	__skb_queue_purge(&buf->tx_done_list);
+
+	return buf->spi_msg->status;
+}
+
+/* The footers of the transfer are classified by now, whether it was processed
+ * successfully or not.
+ */
+static void oa_tc6_account_spi_data_buf(struct oa_tc6 *tc6,
+					struct oa_tc6_spi_data_buf *buf)
+{
+	struct oa_tc6_data_stats *stats = &tc6->data_stats;
+
+	u64_stats_update_begin(&tc6->data_syncp);
+	stats->xfers++;
+	stats->chunks += buf->length / OA_TC6_CHUNK_SIZE;
+	stats->tx_chunks += buf->tx_chunks;
+	stats->rx_chunks += hweight64(tc6->rx_footers.data_valid);
+	u64_stats_update_end(&tc6->data_syncp);
+}
+
+static int oa_tc6_process_spi_data_buf(struct oa_tc6 *tc6,
+				       struct oa_tc6_spi_data_buf *buf,
+				       struct oa_tc6_spi_data_buf *next)
+{
+	int ret;
+
+	ret = oa_tc6_wait_spi_data_buf(tc6, buf);
+	if (ret) {
+		trace_oa_tc6_spi_xfer_end(tc6->netdev,
+					  buf->length / OA_TC6_CHUNK_SIZE, 0,
+					  tc6->tx_credits,
+					  tc6->rx_chunks_available, ret);
+		oa_tc6_put_spi_data_rx_buf(tc6, buf);
+		netdev_err(tc6->netdev, "SPI data transfer failed: %d\n", ret);
+		return ret;
+	}
+
+	tc6->rx_data_buf = buf;
+	ret = oa_tc6_process_spi_data_rx_buf(tc6, buf->length);
+	oa_tc6_put_spi_data_rx_buf(tc6, buf);
+	oa_tc6_account_spi_data_buf(tc6, buf);
+	trace_oa_tc6_spi_xfer_end(tc6->netdev, buf->length / OA_TC6_CHUNK_SIZE,
+				  hweight64(tc6->rx_footers.data_valid),
+				  tc6->tx_credits, tc6->rx_chunks_available,
+				  ret);
+	oa_tc6_deliver_rx_skbs(tc6);
+
+	/* The footers just processed don't account for the transfer which is
+	 * already on the bus.
+	 */
+	if (next) {
+		tc6->tx_credits -= min(tc6->tx_credits, next->tx_chunks);
+		tc6->rx_chunks_available -= min_t(u16, tc6->rx_chunks_available,
+						  next->length /
+						  OA_TC6_CHUNK_SIZE);
+	}
+
+	return ret;
+}
+
+static void oa_tc6_set_buffer_status(struct oa_tc6 *tc6, u32 value)
+{
+	tc6->tx_credits = FIELD_GET(BUFFER_STATUS_TX_CREDITS_AVAILABLE, value);
+	tc6->rx_chunks_available = FIELD_GET(BUFFER_STATUS_RX_CHUNKS_AVAILABLE,
+					     value);
+}
+
+/* Resynchronizes the data path with the MAC-PHY after a loss of frame or a
+ * header error:
+ * 1. waits for the transfer on the bus, whose footers can't be trusted
+ * 2. drops the partial tx and rx frames
+ * 3. clears the error status and takes the tx credits and rx chunks available
+ *    from the buffer status register
+ * The data transfers resume right after, with one transfer forced to read
+ * fresh footers.
+ *
+ * A configuration unsync means the MAC-PHY lost all its settings, normally
+ * through a reset, and only the MAC-PHY driver can replay them. The data
+ * transfers stop instead, so the netdev watchdog triggers the reset and the
+ * replay of the MAC-PHY driver.
+ */
+static int oa_tc6_recover(struct oa_tc6 *tc6, struct oa_tc6_spi_data_buf *cur)
+{
+	struct oa_tc6_error_stats *stats = &tc6->err_stats;
+	u64 start = ktime_get_ns();
+	u64 recovery_ns;
+	u32 value;
+	int ret;
+
+	if (tc6->config_unsync) {
+		/* The cached values aren't the ones of the MAC-PHY anymore */
+		oa_tc6_reg_cache_drop(tc6);
+		netdev_err(tc6->netdev, "MAC-PHY lost its configuration\n");
+		ret = -ENODEV;
+		goto put_cur;
+	}
+
+	if (++tc6->recovery_attempts > OA_TC6_MAX_RECOVERY_ATTEMPTS) {
+		netdev_err(tc6->netdev, "Resynchronization failed\n");
+		ret = -ENODEV;
+		goto put_cur;
+	}
+
+	if (cur) {
+		ret = oa_tc6_wait_spi_data_buf(tc6, cur);
+		oa_tc6_put_spi_data_rx_buf(tc6, cur);
+		if (ret)
+			return ret;
+	}
+
+	oa_tc6_cleanup_ongoing_tx_skb(tc6);
+	oa_tc6_cleanup_ongoing_rx_skb(tc6);
+	tc6->rx_buf_overflow = true;
+
+	ret = oa_tc6_data_read_register(tc6, OA_TC6_REG_STATUS0, &value);
+	if (!ret && value)
+		ret = oa_tc6_data_write_register(tc6, OA_TC6_REG_STATUS0,
+						 value);
+	if (ret)
+		return ret;
+
+	if (FIELD_GET(STATUS0_TTSCAA, value))
+		oa_tc6_complete_tx_tstamp(tc6);
+
+	ret = oa_tc6_data_read_register(tc6, OA_TC6_REG_BUFFER_STATUS, &value);
+	if (ret)
+		return ret;
+
+	oa_tc6_set_buffer_status(tc6, value);
+	set_bit(OA_TC6_EVENT_IRQ, &tc6->events);
+
+	recovery_ns = ktime_get_ns() - start;
+	u64_stats_update_begin(&tc6->err_syncp);
+	stats->recoveries++;
+	stats->recovery_max_ns = max(stats->recovery_max_ns, recovery_ns);
+	u64_stats_update_end(&tc6->err_syncp);
+
+	return 0;
+
+put_cur:
+	/* Nothing may be released while it is still referenced by the bus */
+	if (cur) {
+		oa_tc6_wait_spi_data_buf(tc6, cur);
+		oa_tc6_put_spi_data_rx_buf(tc6, cur);
+	}
+	return ret;
+}
+
+static u16 oa_tc6_max_spi_data_chunks(void)
+{
+	return clamp_t(unsigned int, READ_ONCE(bus_chunk_cap), 1,
+		       OA_TC6_MAX_TX_CHUNKS);
+}
+
+/* Performs SPI data transfers until there is nothing left to do or the
+ * optional chunk budget is used up. Returns 1 in the latter case.
+ */
+static int oa_tc6_try_spi_transfer(struct oa_tc6 *tc6, int *budget)
+{
+	struct oa_tc6_spi_data_buf *prev = NULL;
+	struct oa_tc6_spi_data_buf *cur;
+	bool yielded = false;
+	int max_chunks;
+	int idx = 0;
+	int ret;
+
+	/* Transfer N is queued to the SPI controller before transfer N-1 is
+	 * processed, so the bus keeps running while the received chunks of
+	 * N-1 are parsed and transfer N+1 is prepared.
+	 */
+	while (true) {
+		cur = &tc6->spi_data_bufs[idx];
+		max_chunks = oa_tc6_max_spi_data_chunks();
+		if (budget)
+			max_chunks = min(max_chunks, *budget);
+
+		/* Waiting control requests are performed before the next
+		 * data transfer, which bounds their latency by the transfer
+		 * still on the bus. At least one data transfer is done in
+		 * between, so the data path makes progress anyway.
+		 */
+		if (prev && oa_tc6_ctrl_req_waiting(tc6)) {
+			max_chunks = 0;
+			yielded = true;
+		}
+
+		if (max_chunks <= 0 ||
+		    !oa_tc6_prepare_spi_data_buf(tc6, cur, max_chunks,
+						 prev != NULL)) {
+			cur = NULL;
+		} else {
+			if (budget)
+				*budget -= cur->length / OA_TC6_CHUNK_SIZE;
+
+			ret = oa_tc6_submit_spi_data_buf(tc6, cur);
+			if (ret) {
+				oa_tc6_put_spi_data_rx_buf(tc6, cur);
+				__skb_queue_purge(&cur->tx_done_list);
+				netdev_err(tc6->netdev,
+					   "SPI data transfer failed: %d\n", ret);
+				cur = prev;
+				goto err;
+			}
+		}
+
+		if (!prev && !cur)
+			break;
+
+		if (prev) {
+			ret = oa_tc6_process_spi_data_buf(tc6, prev, cur);
+			if (!ret) {
+				tc6->recovery_attempts = 0;
+			} else if (ret == -EPROTO) {
+				/* The transfer on the bus is released */
+				ret = oa_tc6_recover(tc6, cur);
+				cur = NULL;
+			}
+			if (ret && ret != -EAGAIN)
+				goto err;
+		}
+
+		/* Pairs with the barrier in oa_tc6_start_xmit() */
+		smp_mb();
+		if (oa_tc6_tx_ring_count(tc6) <
+		    READ_ONCE(tc6->tx_skb_queue_size) &&
+		    netif_queue_stopped(tc6->netdev))
+			netif_wake_queue(tc6->netdev);
+
+		prev = cur;
+		idx = (idx + 1) % OA_TC6_SPI_DATA_BUFS;
+	}
+
+	return yielded || (budget && *budget <= 0);
+
+err:
+	/* Nothing may be released while it is still referenced by the bus */
+	if (cur) {
+		oa_tc6_wait_spi_data_buf(tc6, cur);
+		oa_tc6_put_spi_data_rx_buf(tc6, cur);
+	}
+	oa_tc6_cleanup_ongoing_tx_skb(tc6);
+	oa_tc6_cleanup_ongoing_rx_skb(tc6);
+	netdev_err(tc6->netdev, "Device error: %d\n", ret);
+	return ret;
+}
+
+/* The SPI data transfers stop after an error. The stopped tx queue lets the
+ * netdev watchdog notice it even if there is no traffic.
+ */
+static void oa_tc6_data_failed(struct oa_tc6 *tc6)
+{
+	tc6->spi_failed = true;
+	netif_stop_queue(tc6->netdev);
+}
+
+/* Keeps the data engine out of the device, it runs either in the irq thread or
+ * in a bus scheduler round. Disabling the irq isn't enough, irq_wake_thread()
+ * runs the irq thread regardless.
+ */
+static void oa_tc6_engine_lock(struct oa_tc6 *tc6)
+{
+	if (tc6->threaded_irq)
+		mutex_lock(&tc6->irq_thread_lock);
+	else
+		mutex_lock(&tc6->bus->ports_lock);
+}
+
+static void oa_tc6_engine_unlock(struct oa_tc6 *tc6)
+{
+	if (tc6->threaded_irq)
+		mutex_unlock(&tc6->irq_thread_lock);
+	else
+		mutex_unlock(&tc6->bus->ports_lock);
+}
+
+static void oa_tc6_bus_account(struct oa_tc6_bus *bus, struct oa_tc6 *tc6,
+			       u64 time_ns, u32 chunks, u32 ctrl_xfers)
+{
+	u64_stats_update_begin(&bus->syncp);
+	tc6->bus_time_ns += time_ns;
+	tc6->bus_chunks += chunks;
+	tc6->bus_ctrl_xfers += ctrl_xfers;
+	bus->time_ns += time_ns;
+	u64_stats_update_end(&bus->syncp);
+}
+
+static void oa_tc6_run_ctrl_req(struct oa_tc6 *tc6,
+				struct oa_tc6_ctrl_req *req)
+{
+	struct oa_tc6_ctrl_stats *stats = &tc6->ctrl_stats;
+	u64 wait_ns;
+	u64 exec_ns;
+	u64 start;
+
+	start = ktime_get_ns();
+	if (req->msg)
+		req->ret = spi_sync(tc6->spi, req->msg);
+	else
+		req->ret = oa_tc6_txn_run(tc6, container_of(req,
+							    struct oa_tc6_txn,
+							    req));
+	exec_ns = ktime_get_ns() - start;
+	wait_ns = start - req->submit_ns;
+
+	u64_stats_update_begin(&tc6->ctrl_syncp);
+	stats->reqs++;
+	stats->wait_ns += wait_ns;
+	stats->wait_max_ns = max(stats->wait_max_ns, wait_ns);
+	stats->exec_ns += exec_ns;
+	stats->exec_max_ns = max(stats->exec_max_ns, exec_ns);
+	u64_stats_update_end(&tc6->ctrl_syncp);
+
+	if (tc6->bus)
+		oa_tc6_bus_account(tc6->bus, tc6, exec_ns, 0, 1);
+
+	/* The request may be gone as soon as it is completed */
+	req->complete(req);
+}
+
+static struct oa_tc6_ctrl_req *oa_tc6_next_ctrl_req(struct oa_tc6 *tc6,
+						    bool idle, bool capped)
+{
+	struct oa_tc6_ctrl_req *req;
+	unsigned long flags;
+
+	spin_lock_irqsave(&tc6->ctrl_reqs_lock, flags);
+	for (int prio = 0; prio < OA_TC6_CTRL_PRIOS; prio++) {
+		req = list_first_entry_or_null(&tc6->ctrl_reqs[prio],
+					       struct oa_tc6_ctrl_req, node);
+		if (!req)
+			continue;
+
+		if (prio == OA_TC6_CTRL_PRIO_HIGH || idle ||
+		    (!capped && (prio == OA_TC6_CTRL_PRIO_NORMAL ||
+				 oa_tc6_ctrl_req_aged(req)))) {
+			list_del(&req->node);
+			break;
+		}
+		req = NULL;
+	}
+	spin_unlock_irqrestore(&tc6->ctrl_reqs_lock, flags);
+
+	return req;
+}
+
+/* Performs the control requests which are due between two data transfers.
+ * High priority requests are all performed, normal and aged low priority ones
+ * up to ctrl_round_cap. Everything is performed if the data path is idle.
+ */
+static void oa_tc6_run_ctrl_reqs(struct oa_tc6 *tc6, bool idle)
+{
+	unsigned int cap = max(READ_ONCE(ctrl_round_cap), 1U);
+	struct oa_tc6_ctrl_req *req;
+	unsigned int count = 0;
+
+	while ((req = oa_tc6_next_ctrl_req(tc6, idle, count >= cap))) {
+		if (req->prio != OA_TC6_CTRL_PRIO_HIGH)
+			count++;
+		oa_tc6_run_ctrl_req(tc6, req);
+	}
+}
+
+static void oa_tc6_set_ctrl_state(struct oa_tc6 *tc6,
+				  enum oa_tc6_ctrl_state state)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&tc6->ctrl_reqs_lock, flags);
+	tc6->ctrl_state = state;
+	spin_unlock_irqrestore(&tc6->ctrl_reqs_lock, flags);
+}
+
+/* Fails the control requests left behind by the stopped data engine */
+static void oa_tc6_flush_ctrl_reqs(struct oa_tc6 *tc6)
+{
+	struct oa_tc6_ctrl_req *req, *tmp;
+	unsigned long flags;
+	LIST_HEAD(reqs);
+
+	spin_lock_irqsave(&tc6->ctrl_reqs_lock, flags);
+	for (int prio = 0; prio < OA_TC6_CTRL_PRIOS; prio++)
+		list_splice_tail_init(&tc6->ctrl_reqs[prio], &reqs);
+	spin_unlock_irqrestore(&tc6->ctrl_reqs_lock, flags);
+
+	list_for_each_entry_safe(req, tmp, &reqs, node) {
+		req->ret = -ENODEV;
+		req->complete(req);
+	}
+}
+
+static bool oa_tc6_bus_run_round(struct oa_tc6_bus *bus)
+{
+	struct oa_tc6 *tc6;
+	bool busy = false;
+	int deficit;
+	u64 start;
+	int ret;
+
+	/* Deficit round robin: in every round a port with work may transfer
+	 * up to its weight times the chunk cap, so a long burst of one port
+	 * is split up and interleaved with the transfers of the others.
+	 */
+	list_for_each_entry(tc6, &bus->ports, bus_node) {
+		if (tc6->spi_failed ||
+		    !(READ_ONCE(tc6->events) || tc6->bus_pending)) {
+			tc6->bus_deficit = 0;
+			oa_tc6_run_ctrl_reqs(tc6, true);
+			continue;
+		}
+
+		tc6->bus_deficit += READ_ONCE(tc6->bus_weight) *
+				    oa_tc6_max_spi_data_chunks();
+		deficit = tc6->bus_deficit;
+		start = ktime_get_ns();
+
+		/* The transfer loop runs until the tx ring is empty */
+		clear_bit(OA_TC6_EVENT_TX, &tc6->events);
+		ret = oa_tc6_try_spi_transfer(tc6, &tc6->bus_deficit);
+
+		oa_tc6_bus_account(bus, tc6, ktime_get_ns() - start,
+				   deficit - tc6->bus_deficit, 0);
+		if (ret < 0)
+			oa_tc6_data_failed(tc6);
+		tc6->bus_pending = ret > 0;
+		if (!tc6->bus_pending)
+			tc6->bus_deficit = 0;
+		busy = true;
+
+		/* Control requests don't wait for the end of the round */
+		oa_tc6_run_ctrl_reqs(tc6, !tc6->bus_pending);
+	}
+
+	return busy;
+}
+
+static int oa_tc6_bus_thread_handler(void *data)
+{
+	struct oa_tc6_bus *bus = data;
+	bool busy;
+
+	while (likely(!kthread_should_stop())) {
+		/* This kthread will be waken up if there is a tx skb, mac-phy
+		 * interrupt or control transfer on any of the devices.
+		 */
+		wait_event_interruptible(bus->wq, READ_ONCE(bus->work) ||
+					 kthread_should_stop());
+
+		if (kthread_should_stop())
+			break;
+
+		WRITE_ONCE(bus->work, false);
+		/* Pairs with the barrier in oa_tc6_bus_kick() */
+		smp_mb();
+
+		do {
+			mutex_lock(&bus->ports_lock);
+			busy = oa_tc6_bus_run_round(bus);
+			mutex_unlock(&bus->ports_lock);
+		} while (busy);
+	}
+
+	return 0;
+}
+
+static struct oa_tc6_bus *oa_tc6_bus_get(struct spi_controller *ctlr)
+{
+	struct oa_tc6_bus *bus;
+	int ret;
+
+	mutex_lock(&oa_tc6_buses_lock);
+
+	list_for_each_entry(bus, &oa_tc6_buses, node) {
+		if (bus->ctlr == ctlr) {
+			bus->users++;
+			goto unlock;
+		}
+	}
+
+	bus = kzalloc(sizeof(*bus), GFP_KERNEL);
+	if (!bus) {
+		bus = ERR_PTR(-ENOMEM);
+		goto unlock;
+	}
+
+	bus->ctlr = ctlr;
+	bus->users = 1;
+	init_waitqueue_head(&bus->wq);
+	mutex_init(&bus->ports_lock);
+	INIT_LIST_HEAD(&bus->ports);
+	u64_stats_init(&bus->syncp);
+
+	bus->thread = kthread_run(oa_tc6_bus_thread_handler, bus,
+				  "oa-tc6-spi%d", ctlr->bus_num);
+	if (IS_ERR(bus->thread)) {
+		ret = PTR_ERR(bus->thread);
+		kfree(bus);
+		bus = ERR_PTR(ret);
+		goto unlock;
+	}
+
+	sched_set_fifo(bus->thread);
+	list_add(&bus->node, &oa_tc6_buses);
+
+unlock:
+	mutex_unlock(&oa_tc6_buses_lock);
+	return bus;
+}
+
+static void oa_tc6_bus_put(struct oa_tc6_bus *bus)
+{
+	mutex_lock(&oa_tc6_buses_lock);
+
+	if (--bus->users == 0) {
+		list_del(&bus->node);
+		kthread_stop(bus->thread);
+		kfree(bus);
+	}
+
+	mutex_unlock(&oa_tc6_buses_lock);
+}
+
+static int oa_tc6_bus_add_port(struct oa_tc6 *tc6)
+{
+	struct oa_tc6_bus *bus;
+
+	bus = oa_tc6_bus_get(tc6->spi->controller);
+	if (IS_ERR(bus))
+		return PTR_ERR(bus);
+
+	mutex_lock(&bus->ports_lock);
+	list_add_tail(&tc6->bus_node, &bus->ports);
+	tc6->bus = bus;
+	mutex_unlock(&bus->ports_lock);
+
+	return 0;
+}
+
+static void oa_tc6_bus_remove_port(struct oa_tc6 *tc6)
+{
+	struct oa_tc6_bus *bus = tc6->bus;
+
+	mutex_lock(&bus->ports_lock);
+	list_del(&tc6->bus_node);
+	tc6->bus = NULL;
+	mutex_unlock(&bus->ports_lock);
+
+	oa_tc6_bus_put(bus);
+}
+
+static irqreturn_t oa_tc6_macphy_irq_thread(int irq, void *data)
+{
+	struct oa_tc6 *tc6 = data;
+	int ret;
+
+	/* In threaded irq mode the irq thread performs the SPI transfers
+	 * itself. It is woken by the MAC-PHY interrupt, by oa_tc6_start_xmit()
+	 * and by control requests through irq_wake_thread(), which also reruns
+	 * it when new events arrive while it is busy.
+	 */
+	mutex_lock(&tc6->irq_thread_lock);
+	clear_bit(OA_TC6_EVENT_TX, &tc6->events);
+	while (!tc6->spi_failed) {
+		ret = oa_tc6_try_spi_transfer(tc6, NULL);
+		if (ret < 0)
+			oa_tc6_data_failed(tc6);
+		if (ret <= 0)
+			break;
+
+		/* The data transfers made way for control requests */
+		oa_tc6_run_ctrl_reqs(tc6, false);
+	}
+	oa_tc6_run_ctrl_reqs(tc6, true);
+	mutex_unlock(&tc6->irq_thread_lock);
+
+	return IRQ_HANDLED;
+}
+
+static void oa_tc6_kick_spi_transfer(struct oa_tc6 *tc6,
+				     enum oa_tc6_event event)
+{
+	set_bit(event, &tc6->events);
+	oa_tc6_kick_engine(tc6);
+}
+
+static enum hrtimer_restart oa_tc6_launch_timer(struct hrtimer *timer)
+{
+	struct oa_tc6 *tc6 = container_of(timer, struct oa_tc6, launch_timer);
+
+	oa_tc6_kick_spi_transfer(tc6, OA_TC6_EVENT_TX);
+
+	return HRTIMER_NORESTART;
+}
+
+static int oa_tc6_update_buffer_status_from_register(struct oa_tc6 *tc6)
+{
+	u32 value;
+	int ret;
+
+	/* Initially tx credits and rx chunks available to be updated from the
+	 * register as there is no data transfer performed yet. Later they will
+	 * be updated from the rx footer.
+	 */
+	ret = oa_tc6_read_register(tc6, OA_TC6_REG_BUFFER_STATUS, &value);
+	if (ret)
+		return ret;
+
+	oa_tc6_set_buffer_status(tc6, value);
+
+	return 0;
+}
+
+static irqreturn_t oa_tc6_macphy_isr(int irq, void *data)
+{
+	struct oa_tc6 *tc6 = data;
+
+	trace_oa_tc6_irq(tc6->netdev);
+
+	/* MAC-PHY interrupt can occur for the following reasons.
+	 * - availability of tx credits if it was 0 before and not reported in
+	 *   the previous rx footer.
+	 * - availability of rx chunks if it was 0 before and not reported in
+	 *   the previous rx footer.
+	 * - extended status event not reported in the previous rx footer.
+	 */
+	set_bit(OA_TC6_EVENT_IRQ, &tc6->events);
+
+	if (tc6->threaded_irq)
+		return IRQ_WAKE_THREAD;
+
+	/* Wake the bus scheduler to perform spi transfer */
+	oa_tc6_bus_kick(tc6->bus);
+
+	return IRQ_HANDLED;
+}
+
+static int oa_tc6_join_spi_bus(struct oa_tc6 *tc6)
+{
+	int ret;
+
+	ret = oa_tc6_bus_add_port(tc6);
+	if (ret) {
+		dev_err(&tc6->spi->dev, "Failed to create SPI thread\n");
+		return ret;
+	}
+
+	ret = devm_request_irq(&tc6->spi->dev, tc6->spi->irq, oa_tc6_macphy_isr,
+			       IRQF_TRIGGER_FALLING, dev_name(&tc6->spi->dev),
+			       tc6);
+	if (ret) {
+		dev_err(&tc6->spi->dev, "Failed to request macphy isr %d\n",
+			ret);
+		oa_tc6_bus_remove_port(tc6);
+		return ret;
+	}
+
+	return 0;
+}
+
+static int oa_tc6_request_threaded_irq(struct oa_tc6 *tc6)
+{
+	int ret;
+
+	/* The irq thread runs at the same realtime priority as the SPI kthread.
+	 * IRQF_ONESHOT keeps the line masked until the thread returns, an edge
+	 * in the meantime is replayed when it is unmasked.
+	 */
+	ret = devm_request_threaded_irq(&tc6->spi->dev, tc6->spi->irq,
+					oa_tc6_macphy_isr,
+					oa_tc6_macphy_irq_thread,
+					IRQF_TRIGGER_FALLING | IRQF_ONESHOT,
+					dev_name(&tc6->spi->dev), tc6);
+	if (ret)
+		dev_err(&tc6->spi->dev,
+			"Failed to request macphy threaded isr %d\n", ret);
+
+	return ret;
+}
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 10, 0)
+static void oa_tc6_unoptimize_spi_msg(void *msg)
+{
+	spi_unoptimize_message(msg);
+}
+#endif
+
+static int oa_tc6_init_spi_msg(struct oa_tc6 *tc6, struct spi_message *msg,
+			       struct spi_transfer *xfer, void *tx_buf,
+			       void *rx_buf, unsigned int len, bool optimize)
+{
+	xfer->tx_buf = tx_buf;
+	xfer->rx_buf = rx_buf;
+	xfer->len = len;
+	spi_message_init_with_transfers(msg, xfer, 1);
+
+	/* An optimized message is validated and prepared for the controller
+	 * once instead of on every submission, but it must not be changed
+	 * anymore.
+	 */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 10, 0)
+	if (optimize) {
+		int ret = spi_optimize_message(tc6->spi, msg);
+
+		if (ret)
+			return ret;
+
+		return devm_add_action_or_reset(&tc6->spi->dev,
+						oa_tc6_unoptimize_spi_msg, msg);
+	}
+#endif
+
+	return 0;
+}
+
+static int oa_tc6_init_ctrl_buf(struct oa_tc6 *tc6, struct oa_tc6_ctrl_buf *ctrl)
+{
+	int ret;
+
+	ctrl->tx_buf = devm_kzalloc(&tc6->spi->dev, OA_TC6_CTRL_SPI_BUF_SIZE,
+				    GFP_KERNEL);
+	if (!ctrl->tx_buf)
+		return -ENOMEM;
+
+	ctrl->rx_buf = devm_kzalloc(&tc6->spi->dev, OA_TC6_CTRL_SPI_BUF_SIZE,
+				    GFP_KERNEL);
+	if (!ctrl->rx_buf)
+		return -ENOMEM;
+
+	ret = oa_tc6_init_spi_msg(tc6, &ctrl->msg, &ctrl->xfer, ctrl->tx_buf,
+				  ctrl->rx_buf, 0, false);
+	if (ret)
+		return ret;
+
+	return oa_tc6_init_spi_msg(tc6, &ctrl->reg_msg, &ctrl->reg_xfer,
+				   ctrl->tx_buf, ctrl->rx_buf,
+				   OA_TC6_CTRL_REG_SPI_SIZE, true);
+}
+
+static int oa_tc6_init_spi_data_buf(struct oa_tc6 *tc6,
+				    struct oa_tc6_spi_data_buf *buf)
+{
+	int ret;
+
+	buf->tx_buf = devm_kzalloc(&tc6->spi->dev, OA_TC6_SPI_DATA_BUF_SIZE,
+				   GFP_KERNEL);
+	if (!buf->tx_buf)
+		return -ENOMEM;
+
+	buf->rx_fallback_buf = devm_kzalloc(&tc6->spi->dev,
+					    OA_TC6_SPI_DATA_BUF_SIZE,
+					    GFP_KERNEL);
+	if (!buf->rx_fallback_buf)
+		return -ENOMEM;
+
+	buf->xfers = devm_kcalloc(&tc6->spi->dev, OA_TC6_MAX_SPI_DATA_XFERS,
+				  sizeof(*buf->xfers), GFP_KERNEL);
+	if (!buf->xfers)
+		return -ENOMEM;
+
+	init_completion(&buf->done);
+	__skb_queue_head_init(&buf->tx_done_list);
+
+	ret = oa_tc6_init_spi_msg(tc6, &buf->msg, &buf->xfer, buf->tx_buf,
+				  NULL, 0, false);
+	if (ret)
+		return ret;
+
+	buf->msg.complete = oa_tc6_spi_data_complete;
+	buf->msg.context = buf;
+
+	ret = oa_tc6_init_spi_msg(tc6, &buf->chunk_msg, &buf->chunk_xfer,
+				  buf->tx_buf, buf->rx_fallback_buf,
+				  OA_TC6_CHUNK_SIZE, true);
+	if (ret)
+		return ret;
+
+	buf->chunk_msg.complete = oa_tc6_spi_data_complete;
+	buf->chunk_msg.context = buf;
+
+	return 0;
+}
+
+static int oa_tc6_create_page_pool(struct oa_tc6 *tc6)
+{
+	struct page_pool_params pp_params = {
+		.order = 0,
+		.pool_size = OA_TC6_RX_PAGE_POOL_SIZE,
+		.nid = NUMA_NO_NODE,
+		.dev = &tc6->spi->dev,
+	};
+
+	/* A whole SPI data transfer is received into a single page */
+	BUILD_BUG_ON(OA_TC6_SPI_DATA_BUF_SIZE > PAGE_SIZE);
+
+	/* Several received frames share one page */
+#ifdef PP_FLAG_PAGE_FRAG
+	pp_params.flags |= PP_FLAG_PAGE_FRAG;
+#endif
+
+	tc6->page_pool = page_pool_create(&pp_params);
+	if (IS_ERR(tc6->page_pool))
+		return PTR_ERR(tc6->page_pool);
+
+	return 0;
+}
+
+/**
+ * oa_tc6_start_xmit - function for sending the tx skb which consists ethernet
+ * frame.
+ * @tc6: oa_tc6 struct.
+ * @skb: socket buffer in which the ethernet frame is stored.
+ *
+ * The transmit queue is stopped as soon as the tx ring fill level reaches the
+ * configured tx queue size, so
+ * NETDEV_TX_BUSY is not expected to be returned in normal operation.
+ *
+ * Returns NETDEV_TX_OK if the transmit ethernet frame skb added in the tx ring
+ * otherwise returns NETDEV_TX_BUSY.
+ */
+netdev_tx_t oa_tc6_start_xmit(struct oa_tc6 *tc6, struct sk_buff *skb)
+{
+	u32 queue_size = READ_ONCE(tc6->tx_skb_queue_size);
+
+	if (oa_tc6_tx_ring_count(tc6) >= queue_size) {
+		netif_stop_queue(tc6->netdev);
+		return NETDEV_TX_BUSY;
+	}
+
+	/* Page fragments are walked by the tx chunk builder, only a frag list
+	 * needs to be linearized.
+	 */
+	if (skb_has_frag_list(skb) && __skb_linearize(skb)) {
+		dev_kfree_skb_any(skb);
+		DEV_STATS_INC(tc6->netdev, tx_dropped);
+		return NETDEV_TX_OK;
+	}
+
+	/* A pending hardware timestamp suppresses the software one */
+	if (unlikely(skb_shinfo(skb)->tx_flags & SKBTX_HW_TSTAMP) &&
+	    READ_ONCE(tc6->hwtstamp_tx))
+		skb_shinfo(skb)->tx_flags |= SKBTX_IN_PROGRESS;
+	skb_tx_timestamp(skb);
+	netdev_sent_queue(tc6->netdev, skb->len);
+	trace_oa_tc6_tx_enqueue(tc6->netdev, skb);
+	oa_tc6_tx_ring_push(tc6, skb);
+
+	/* Stop the queue before it overflows. The SPI thread may have drained
+	 * the queue in the meantime, so check again after stopping it.
+	 */
+	if (oa_tc6_tx_ring_count(tc6) >= queue_size) {
+		netif_stop_queue(tc6->netdev);
+		smp_mb();
+		if (oa_tc6_tx_ring_count(tc6) < queue_size)
+			netif_start_queue(tc6->netdev);
+	}
+
+	oa_tc6_kick_spi_transfer(tc6, OA_TC6_EVENT_TX);
+
+	return NETDEV_TX_OK;
+}
+EXPORT_SYMBOL_GPL(oa_tc6_start_xmit);
+
+/**
+ * oa_tc6_set_tx_queue_size - function for setting the tx skb queue depth.
+ * @tc6: oa_tc6 struct.
+ * @size: maximum number of tx skbs waiting for the SPI thread.
+ *
+ * Returns 0 on success otherwise failed.
+ */
+int oa_tc6_set_tx_queue_size(struct oa_tc6 *tc6, u32 size)
+{
+	if (!size || size > OA_TC6_TX_SKB_QUEUE_MAX_SIZE)
+		return -EINVAL;
+
+	WRITE_ONCE(tc6->tx_skb_queue_size, size);
+
+	/* Pairs with the barrier in oa_tc6_start_xmit() */
+	smp_mb();
+	if (oa_tc6_tx_ring_count(tc6) < size &&
+	    netif_queue_stopped(tc6->netdev))
+		netif_wake_queue(tc6->netdev);
+
+	return 0;
 }
+EXPORT_SYMBOL_GPL(oa_tc6_set_tx_queue_size);
 
-static u16 oa_tc6_prepare_spi_tx_buf_for_tx_skbs(struct oa_tc6 *tc6)
+/**
+ * oa_tc6_get_tx_queue_size - function for reading the tx skb queue depth.
+ * @tc6: oa_tc6 struct.
+ *
+ * Returns the maximum number of tx skbs waiting for the SPI thread.
+ */
+u32 oa_tc6_get_tx_queue_size(struct oa_tc6 *tc6)
 {
-	u16 used_tx_credits;
+	return READ_ONCE(tc6->tx_skb_queue_size);
+}
+EXPORT_SYMBOL_GPL(oa_tc6_get_tx_queue_size);
 
-	/* Get tx skbs and convert them into tx chunks based on the tx credits
-	 * available.
-	 */
-	for (used_tx_credits = 0; used_tx_credits < tc6->tx_credits;
-	     used_tx_credits++) {
-		if (!tc6->tx_skb)
-			tc6->tx_skb = skb_dequeue(&tc6->tx_skb_q);
-		if (!tc6->tx_skb)
-			break;
-		oa_tc6_add_tx_skb_to_spi_buf(tc6);
-	}
+/**
+ * oa_tc6_set_tx_zero_copy - function for selecting the tx data path.
+ * @tc6: oa_tc6 struct.
+ * @enable: true to let the SPI controller gather the tx chunk payloads
+ * directly from the skbs, false to copy them into the SPI tx buffer.
+ *
+ * The new mode is used from the next SPI data transfer on.
+ */
+void oa_tc6_set_tx_zero_copy(struct oa_tc6 *tc6, bool enable)
+{
+	WRITE_ONCE(tc6->tx_zero_copy, enable);
+}
+EXPORT_SYMBOL_GPL(oa_tc6_set_tx_zero_copy);
 
-	return used_tx_credits * OA_TC6_CHUNK_SIZE;
+/**
+ * oa_tc6_get_tx_zero_copy - function for reading the tx data path mode.
+ * @tc6: oa_tc6 struct.
+ *
+ * Returns true if the zero-copy tx data path is selected.
+ */
+bool oa_tc6_get_tx_zero_copy(struct oa_tc6 *tc6)
+{
+	return READ_ONCE(tc6->tx_zero_copy);
 }
+EXPORT_SYMBOL_GPL(oa_tc6_get_tx_zero_copy);
 
-static void oa_tc6_add_empty_chunks_to_spi_buf(struct oa_tc6 *tc6,
-					       u16 needed_empty_chunks)
+/**
+ * oa_tc6_set_tx_packing - function for packing the tx frames into the chunks.
+ * @tc6: oa_tc6 struct.
+ * @enable: true to start a tx frame in the chunk where the previous one ends,
+ * false to start every tx frame in a fresh chunk.
+ *
+ * The new mode is used from the next SPI data transfer on.
+ *
+ * Returns 0 on success, -EOPNOTSUPP if the MAC-PHY revision doesn't support
+ * tx frame packing.
+ */
+int oa_tc6_set_tx_packing(struct oa_tc6 *tc6, bool enable)
 {
-	__be32 header;
+	if (enable && !(tc6->caps & OA_TC6_CAP_TX_PACKING))
+		return -EOPNOTSUPP;
 
-	header = oa_tc6_prepare_data_header(OA_TC6_DATA_INVALID,
-					    OA_TC6_DATA_START_INVALID,
-					    OA_TC6_DATA_END_INVALID, 0);
+	WRITE_ONCE(tc6->tx_packing, enable);
 
-	while (needed_empty_chunks--) {
-		__be32 *tx_buf = tc6->spi_data_tx_buf + tc6->spi_data_tx_buf_offset;
+	return 0;
+}
+EXPORT_SYMBOL_GPL(oa_tc6_set_tx_packing);
 
-		*tx_buf = header;
-		tc6->spi_data_tx_buf_offset += OA_TC6_CHUNK_SIZE;
-	}
+/**
+ * oa_tc6_get_tx_packing - function for reading the tx frame packing mode.
+ * @tc6: oa_tc6 struct.
+ *
+ * Returns true if the tx frames are packed into the chunks.
+ */
+bool oa_tc6_get_tx_packing(struct oa_tc6 *tc6)
+{
+	return READ_ONCE(tc6->tx_packing);
 }
+EXPORT_SYMBOL_GPL(oa_tc6_get_tx_packing);
 
-static u16 oa_tc6_prepare_spi_tx_buf_for_rx_chunks(struct oa_tc6 *tc6, u16 len)
+/**
+ * oa_tc6_set_bus_weight - function for setting the SPI bus scheduler weight.
+ * @tc6: oa_tc6 struct.
+ * @weight: share of the SPI bus relative to the other devices on it.
+ *
+ * Returns 0 on success otherwise failed.
+ */
+int oa_tc6_set_bus_weight(struct oa_tc6 *tc6, u32 weight)
 {
-	u16 tx_chunks = len / OA_TC6_CHUNK_SIZE;
-	u16 needed_empty_chunks;
+	if (!weight || weight > OA_TC6_BUS_WEIGHT_MAX)
+		return -EINVAL;
 
-	/* If there are more chunks to receive than to transmit, we need to add
-	 * enough empty tx chunks to allow the reception of the excess rx
-	 * chunks.
-	 */
-	if (tx_chunks >= tc6->rx_chunks_available)
-		return len;
+	WRITE_ONCE(tc6->bus_weight, weight);
 
-	needed_empty_chunks = tc6->rx_chunks_available - tx_chunks;
+	return 0;
+}
+EXPORT_SYMBOL_GPL(oa_tc6_set_bus_weight);
 
-	oa_tc6_add_empty_chunks_to_spi_buf(tc6, needed_empty_chunks);
+/**
+ * oa_tc6_get_bus_stats - function for reading the SPI bus usage.
+ * @tc6: oa_tc6 struct.
+ * @stats: filled with the bus usage of the device and of the whole bus.
+ *
+ * The statistics are only collected by the bus scheduler, so they remain
+ * zero in threaded irq mode.
+ */
+void oa_tc6_get_bus_stats(struct oa_tc6 *tc6, struct oa_tc6_bus_stats *stats)
+{
+	struct oa_tc6_bus *bus = tc6->bus;
+	unsigned int start;
+
+	memset(stats, 0, sizeof(*stats));
+	if (!bus)
+		return;
+
+	do {
+		start = u64_stats_fetch_begin(&bus->syncp);
+		stats->port_time_ns = tc6->bus_time_ns;
+		stats->port_chunks = tc6->bus_chunks;
+		stats->port_ctrl_xfers = tc6->bus_ctrl_xfers;
+		stats->bus_time_ns = bus->time_ns;
+	} while (u64_stats_fetch_retry(&bus->syncp, start));
+}
+EXPORT_SYMBOL_GPL(oa_tc6_get_bus_stats);
 
-	return needed_empty_chunks * OA_TC6_CHUNK_SIZE + len;
+/**
+ * oa_tc6_get_ctrl_stats - function for reading the control request latencies.
+ * @tc6: oa_tc6 struct.
+ * @stats: filled with the waiting and execution times of the control requests
+ * performed by the data engine.
+ *
+ * The execution time of a control request is the time the data transfers are
+ * stalled by it.
+ */
+void oa_tc6_get_ctrl_stats(struct oa_tc6 *tc6, struct oa_tc6_ctrl_stats *stats)
+{
+	unsigned int start;
+
+	do {
+		start = u64_stats_fetch_begin(&tc6->ctrl_syncp);
+		*stats = tc6->ctrl_stats;
+	} while (u64_stats_fetch_retry(&tc6->ctrl_syncp, start));
 }
+EXPORT_SYMBOL_GPL(oa_tc6_get_ctrl_stats);
 
-static int oa_tc6_try_spi_transfer(struct oa_tc6 *tc6)
+/**
+ * oa_tc6_reset_macphy - function for resetting a stalled MAC-PHY.
+ * @tc6: oa_tc6 struct.
+ *
+ * Stops the SPI data transfers, drops the queued tx frames, performs a
+ * software reset of the MAC-PHY and initializes its standard registers and
+ * the internal PHY again, which gets its fixups and PLCA settings back from
+ * the PHY driver. The control requests are still performed meanwhile, so the
+ * caller can replay the MAC specific configuration before the SPI data
+ * transfers are restarted with oa_tc6_restart_data().
+ *
+ * Returns 0 on success otherwise failed error code.
+ */
+int oa_tc6_reset_macphy(struct oa_tc6 *tc6)
 {
+	struct sk_buff *skb;
 	int ret;
 
-	while (true) {
-		u16 spi_length = 0;
+	tc6->reset_start_ns = ktime_get_ns();
+	netif_tx_disable(tc6->netdev);
 
-		tc6->spi_data_tx_buf_offset = 0;
+	oa_tc6_engine_lock(tc6);
+	tc6->spi_failed = true;
+	/* The held frame it would release is dropped below */
+	hrtimer_cancel(&tc6->launch_timer);
+	oa_tc6_engine_unlock(tc6);
 
-		if (tc6->tx_skb || !skb_queue_empty(&tc6->tx_skb_q))
-			spi_length = oa_tc6_prepare_spi_tx_buf_for_tx_skbs(tc6);
+	/* The data engine doesn't touch the device anymore */
+	oa_tc6_cleanup_ongoing_tx_skb(tc6);
+	oa_tc6_cleanup_ongoing_rx_skb(tc6);
+	oa_tc6_drop_tx_tstamp(tc6);
+	while ((skb = oa_tc6_tx_ring_pop(tc6)))
+		dev_kfree_skb_any(skb);
+	netdev_reset_queue(tc6->netdev);
+	tc6->tx_completed_pkts = 0;
+	tc6->tx_completed_bytes = 0;
 
-		if (tc6->rx_chunks_available)
-			spi_length = oa_tc6_prepare_spi_tx_buf_for_rx_chunks(tc6, spi_length);
+	ret = oa_tc6_sw_reset_macphy(tc6);
+	if (ret) {
+		netdev_err(tc6->netdev, "MAC-PHY software reset failed: %d\n",
+			   ret);
+		return ret;
+	}
 
-		if (tc6->int_flag) {
-			tc6->int_flag = false;
-			if (spi_length == 0) {
-				oa_tc6_add_empty_chunks_to_spi_buf(tc6, 1);
-				spi_length = OA_TC6_CHUNK_SIZE;
-			}
-		}
+	ret = oa_tc6_unmask_macphy_interrupts(tc6);
+	if (ret) {
+		netdev_err(tc6->netdev,
+			   "MAC-PHY interrupts unmask failed: %d\n", ret);
+		return ret;
+	}
 
-		if (spi_length == 0)
-			break;
+	ret = phy_init_hw(tc6->phydev);
+	if (ret)
+		netdev_err(tc6->netdev,
+			   "MAC internal PHY initialization failed: %d\n", ret);
 
-		ret = oa_tc6_spi_transfer(tc6, OA_TC6_DATA_HEADER, spi_length);
+	return ret;
+}
+EXPORT_SYMBOL_GPL(oa_tc6_reset_macphy);
+
+/**
+ * oa_tc6_restart_data - function for restarting the SPI data transfers after
+ * a MAC-PHY reset.
+ * @tc6: oa_tc6 struct.
+ *
+ * Enables the data transfer of the reset MAC-PHY, restarts the SPI data
+ * transfers and wakes up the tx queue. The time since the start of
+ * oa_tc6_reset_macphy() is reported as the recovery time.
+ *
+ * Returns 0 on success otherwise failed error code.
+ */
+int oa_tc6_restart_data(struct oa_tc6 *tc6)
+{
+	struct oa_tc6_error_stats *stats = &tc6->err_stats;
+	u64 reset_ns;
+	int ret;
+
+	if (tc6->hwtstamp_tx || tc6->hwtstamp_rx) {
+		ret = oa_tc6_enable_frame_tstamps(tc6, true);
 		if (ret) {
-			netdev_err(tc6->netdev, "SPI data transfer failed: %d\n",
+			netdev_err(tc6->netdev,
+				   "Failed to enable frame timestamps: %d\n",
 				   ret);
 			return ret;
 		}
+	}
 
-		ret = oa_tc6_process_spi_data_rx_buf(tc6, spi_length);
-		if (ret) {
-			if (ret == -EAGAIN)
-				continue;
-
-			oa_tc6_cleanup_ongoing_tx_skb(tc6);
-			oa_tc6_cleanup_ongoing_rx_skb(tc6);
-			netdev_err(tc6->netdev, "Device error: %d\n", ret);
-			return ret;
-		}
+	ret = oa_tc6_enable_data_transfer(tc6);
+	if (ret) {
+		netdev_err(tc6->netdev, "Failed to enable data transfer: %d\n",
+			   ret);
+		return ret;
+	}
 
-		if (skb_queue_len(&tc6->tx_skb_q) < OA_TC6_TX_SKB_QUEUE_SIZE &&
-		    netif_queue_stopped(tc6->netdev))
-			netif_wake_queue(tc6->netdev);
+	ret = oa_tc6_update_buffer_status_from_register(tc6);
+	if (ret) {
+		netdev_err(tc6->netdev, "Failed to update buffer status: %d\n",
+			   ret);
+		return ret;
 	}
 
-	return 0;
-}
+	tc6->rx_buf_overflow = false;
+	tc6->config_unsync = false;
+	tc6->recovery_attempts = 0;
 
-static int oa_tc6_spi_thread_handler(void *data)
-{
-	struct oa_tc6 *tc6 = data;
-	int ret;
+	oa_tc6_engine_lock(tc6);
+	tc6->spi_failed = false;
+	oa_tc6_engine_unlock(tc6);
 
-	while (likely(!kthread_should_stop())) {
-		/* This kthread will be waken up if there is a tx skb or mac-phy
-		 * interrupt to perform spi transfer with tx chunks.
-		 */
-		wait_event_interruptible(tc6->spi_wq, tc6->int_flag ||
-					 !skb_queue_empty(&tc6->tx_skb_q) ||
-					 kthread_should_stop());
+	reset_ns = ktime_get_ns() - tc6->reset_start_ns;
+	u64_stats_update_begin(&tc6->err_syncp);
+	stats->resets++;
+	stats->reset_max_ns = max(stats->reset_max_ns, reset_ns);
+	u64_stats_update_end(&tc6->err_syncp);
+	netdev_info(tc6->netdev, "MAC-PHY reset and reconfigured in %llu us\n",
+		    div_u64(reset_ns, NSEC_PER_USEC));
 
-		if (kthread_should_stop())
-			break;
+	netif_wake_queue(tc6->netdev);
 
-		ret = oa_tc6_try_spi_transfer(tc6);
-		if (ret)
-			return ret;
-	}
+	/* Deasserts the reset complete interrupt, see oa_tc6_init() */
+	oa_tc6_kick_spi_transfer(tc6, OA_TC6_EVENT_IRQ);
 
 	return 0;
 }
+EXPORT_SYMBOL_GPL(oa_tc6_restart_data);
 
-static int oa_tc6_update_buffer_status_from_register(struct oa_tc6 *tc6)
+/**
+ * oa_tc6_hwtstamp_set - function for configuring the frame timestamping.
+ * @tc6: oa_tc6 struct.
+ * @config: requested configuration, updated to the one applied.
+ *
+ * The MAC-PHY timestamps every received frame once any receive filter is
+ * requested. The rx timestamps come inline in the data chunks, only the tx
+ * timestamps are read from the MAC-PHY registers.
+ *
+ * Returns 0 on success otherwise failed error code.
+ */
+int oa_tc6_hwtstamp_set(struct oa_tc6 *tc6, struct hwtstamp_config *config)
 {
-	u32 value;
+	bool tx, rx;
 	int ret;
 
-	/* Initially tx credits and rx chunks available to be updated from the
-	 * register as there is no data transfer performed yet. Later they will
-	 * be updated from the rx footer.
-	 */
-	ret = oa_tc6_read_register(tc6, OA_TC6_REG_BUFFER_STATUS, &value);
+	switch (config->tx_type) {
+	case HWTSTAMP_TX_OFF:
+		tx = false;
+		break;
+	case HWTSTAMP_TX_ON:
+		tx = true;
+		break;
+	default:
+		return -ERANGE;
+	}
+
+	rx = config->rx_filter != HWTSTAMP_FILTER_NONE;
+	if (rx)
+		config->rx_filter = HWTSTAMP_FILTER_ALL;
+
+	ret = oa_tc6_enable_frame_tstamps(tc6, tx || rx);
 	if (ret)
 		return ret;
 
-	tc6->tx_credits = FIELD_GET(BUFFER_STATUS_TX_CREDITS_AVAILABLE, value);
-	tc6->rx_chunks_available = FIELD_GET(BUFFER_STATUS_RX_CHUNKS_AVAILABLE,
-					     value);
+	WRITE_ONCE(tc6->hwtstamp_tx, tx);
+	WRITE_ONCE(tc6->hwtstamp_rx, rx);
 
 	return 0;
 }
+EXPORT_SYMBOL_GPL(oa_tc6_hwtstamp_set);
 
-static irqreturn_t oa_tc6_macphy_isr(int irq, void *data)
+/**
+ * oa_tc6_hwtstamp_get - function for reading the frame timestamping
+ * configuration.
+ * @tc6: oa_tc6 struct.
+ * @config: filled with the current configuration.
+ */
+void oa_tc6_hwtstamp_get(struct oa_tc6 *tc6, struct hwtstamp_config *config)
 {
-	struct oa_tc6 *tc6 = data;
+	config->flags = 0;
+	config->tx_type = READ_ONCE(tc6->hwtstamp_tx) ? HWTSTAMP_TX_ON :
+							HWTSTAMP_TX_OFF;
+	config->rx_filter = READ_ONCE(tc6->hwtstamp_rx) ? HWTSTAMP_FILTER_ALL :
+							  HWTSTAMP_FILTER_NONE;
+}
+EXPORT_SYMBOL_GPL(oa_tc6_hwtstamp_get);
 
-	/* MAC-PHY interrupt can occur for the following reasons.
-	 * - availability of tx credits if it was 0 before and not reported in
-	 *   the previous rx footer.
-	 * - availability of rx chunks if it was 0 before and not reported in
-	 *   the previous rx footer.
-	 * - extended status event not reported in the previous rx footer.
-	 */
-	tc6->int_flag = true;
-	/* Wake spi kthread to perform spi transfer */
-	wake_up_interruptible(&tc6->spi_wq);
+/**
+ * oa_tc6_get_error_stats - function for reading the data path error counters.
+ * @tc6: oa_tc6 struct.
+ * @stats: filled with the number of framing errors, of the in place
+ * resynchronizations of the data path they caused and of the MAC-PHY resets.
+ */
+void oa_tc6_get_error_stats(struct oa_tc6 *tc6,
+			    struct oa_tc6_error_stats *stats)
+{
+	unsigned int start;
 
-	return IRQ_HANDLED;
+	do {
+		start = u64_stats_fetch_begin(&tc6->err_syncp);
+		*stats = tc6->err_stats;
+	} while (u64_stats_fetch_retry(&tc6->err_syncp, start));
 }
+EXPORT_SYMBOL_GPL(oa_tc6_get_error_stats);
 
 /**
- * oa_tc6_start_xmit - function for sending the tx skb which consists ethernet
- * frame.
+ * oa_tc6_get_data_stats - function for reading the SPI data transfer counters.
  * @tc6: oa_tc6 struct.
- * @skb: socket buffer in which the ethernet frame is stored.
+ * @stats: filled with the number of SPI data transfers, of their chunks and
+ * of the events which held up the data path.
  *
- * Returns NETDEV_TX_OK if the transmit ethernet frame skb added in the tx_skb_q
- * otherwise returns NETDEV_TX_BUSY.
+ * The chunks without tx data are sent to receive or to read the footers only,
+ * so they tell how much of the bus time the tx direction leaves unused.
  */
-netdev_tx_t oa_tc6_start_xmit(struct oa_tc6 *tc6, struct sk_buff *skb)
+void oa_tc6_get_data_stats(struct oa_tc6 *tc6, struct oa_tc6_data_stats *stats)
 {
-	if (skb_queue_len(&tc6->tx_skb_q) > OA_TC6_TX_SKB_QUEUE_SIZE) {
-		netif_stop_queue(tc6->netdev);
-		return NETDEV_TX_BUSY;
-	}
+	unsigned int start;
 
-	if (skb_linearize(skb)) {
-		dev_kfree_skb_any(skb);
-		tc6->netdev->stats.tx_dropped++;
-		return NETDEV_TX_OK;
-	}
+	do {
+		start = u64_stats_fetch_begin(&tc6->data_syncp);
+		*stats = tc6->data_stats;
+	} while (u64_stats_fetch_retry(&tc6->data_syncp, start));
+}
+EXPORT_SYMBOL_GPL(oa_tc6_get_data_stats);
 
-	skb_queue_tail(&tc6->tx_skb_q, skb);
+/**
+ * oa_tc6_get_stats64 - function for reading the network device statistics.
+ * @tc6: oa_tc6 struct.
+ * @stats: filled with the packet and byte counters of the data engine and the
+ * drop and error counters of the network device.
+ */
+void oa_tc6_get_stats64(struct oa_tc6 *tc6, struct rtnl_link_stats64 *stats)
+{
+	unsigned int start;
 
-	/* Wake spi kthread to perform spi transfer */
-	wake_up_interruptible(&tc6->spi_wq);
+	netdev_stats_to_stats64(stats, &tc6->netdev->stats);
 
-	return NETDEV_TX_OK;
+	do {
+		start = u64_stats_fetch_begin(&tc6->data_syncp);
+		stats->rx_packets = tc6->data_stats.rx_packets;
+		stats->rx_bytes = tc6->data_stats.rx_bytes;
+		stats->tx_packets = tc6->data_stats.tx_packets;
+		stats->tx_bytes = tc6->data_stats.tx_bytes;
+	} while (u64_stats_fetch_retry(&tc6->data_syncp, start));
 }
-EXPORT_SYMBOL_GPL(oa_tc6_start_xmit);
+EXPORT_SYMBOL_GPL(oa_tc6_get_stats64);
+
+/**
+ * oa_tc6_set_volatile_reg - function for declaring MAC-PHY specific volatile
+ * registers.
+ * @tc6: oa_tc6 struct.
+ * @volatile_reg: returns true for the registers which must not be cached.
+ *
+ * Registers which are changed by the MAC-PHY itself or which have side effects
+ * on access, like statistics counters, must always be accessed in the MAC-PHY.
+ * The standard OPEN Alliance status registers and the PHY registers are never
+ * cached anyway.
+ */
+void oa_tc6_set_volatile_reg(struct oa_tc6 *tc6, bool (*volatile_reg)(u32))
+{
+	tc6->volatile_reg = volatile_reg;
+}
+EXPORT_SYMBOL_GPL(oa_tc6_set_volatile_reg);
+
+/**
+ * oa_tc6_set_event_capture - function for reading MAC-PHY specific event
+ * registers on an interrupt.
+ * @tc6: oa_tc6 struct.
+ * @capture: event registers and handler, NULL to stop the capture.
+ *
+ * When a STATUS1 bit of @capture is set, the SPI data transfer loop reads the
+ * event registers with one burst read right where the extended status is
+ * processed, without polling the MAC-PHY. The handler is called from the SPI
+ * data transfer context and must not access the MAC-PHY registers itself.
+ * The MAC-PHY driver unmasks the events in INT_MASK1.
+ *
+ * The capture is replaced with the data engine locked out, in the irq thread
+ * as well as in the bus thread, so the previous one isn't used anymore once
+ * this returns and may be freed.
+ *
+ * Returns 0 on success otherwise failed error code.
+ */
+int oa_tc6_set_event_capture(struct oa_tc6 *tc6,
+			     struct oa_tc6_event_capture *capture)
+{
+	if (capture && (!capture->length ||
+			capture->length > OA_TC6_EVENT_CAPTURE_MAX_REGS))
+		return -EINVAL;
+
+	/* Neither the handler nor the event registers of the previous capture
+	 * are used by the engine anymore once it is replaced.
+	 */
+	oa_tc6_engine_lock(tc6);
+	tc6->event_capture = capture;
+	oa_tc6_engine_unlock(tc6);
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(oa_tc6_set_event_capture);
+
+/**
+ * oa_tc6_set_launch_time - function for holding the tx frames until their
+ * launch time.
+ * @tc6: oa_tc6 struct.
+ * @enable: true to honor the launch time in skb->tstamp of the tx frames.
+ *
+ * The launch times are in PHC time, which is derived from the system clock
+ * with the offset reported by oa_tc6_set_phc_offset(). A frame is released
+ * into the SPI data transfers ahead of its launch time by the latency the
+ * tx timestamps of the launch time frames have shown so far. Frames without
+ * a launch time are sent right away.
+ *
+ * The mode is switched with the data engine locked out, in the irq thread as
+ * well as in the bus thread. Once disabled the launch timer is cancelled
+ * before the engine runs again, so it isn't armed anymore when this returns.
+ */
+void oa_tc6_set_launch_time(struct oa_tc6 *tc6, bool enable)
+{
+	bool held;
+
+	/* The engine doesn't arm the launch timer anymore once disabled */
+	oa_tc6_engine_lock(tc6);
+	held = tc6->launch_time && !enable;
+	tc6->launch_time = enable;
+	if (!enable)
+		hrtimer_cancel(&tc6->launch_timer);
+	oa_tc6_engine_unlock(tc6);
+
+	if (held)
+		oa_tc6_kick_spi_transfer(tc6, OA_TC6_EVENT_TX);
+}
+EXPORT_SYMBOL_GPL(oa_tc6_set_launch_time);
+
+/**
+ * oa_tc6_set_phc_offset - function for reporting the offset of the MAC-PHY
+ * wall clock.
+ * @tc6: oa_tc6 struct.
+ * @offset_ns: PHC time minus CLOCK_REALTIME, in nanoseconds.
+ *
+ * The MAC-PHY driver measures the offset by reading its clock with system
+ * timestamps, often enough for the drift in between to stay well below the
+ * launch time accuracy needed.
+ */
+void oa_tc6_set_phc_offset(struct oa_tc6 *tc6, s64 offset_ns)
+{
+	atomic64_set(&tc6->phc_offset_ns, offset_ns);
+}
+EXPORT_SYMBOL_GPL(oa_tc6_set_phc_offset);
 
 /**
  * oa_tc6_init - allocates and initializes oa_tc6 structure.
@@ -1202,33 +4149,62 @@ struct oa_tc6 *oa_tc6_init(struct spi_device *spi, struct net_device *netdev)
 
 	tc6->spi = spi;
 	tc6->netdev = netdev;
+	tc6->tx_skb_queue_size = OA_TC6_TX_SKB_QUEUE_SIZE;
+	tc6->bus_weight = 1;
+
+	/* Tx ring indices are free running and masked on access */
+	BUILD_BUG_ON(!is_power_of_2(OA_TC6_TX_RING_SIZE));
+	BUILD_BUG_ON(OA_TC6_TX_RING_SIZE < OA_TC6_TX_SKB_QUEUE_MAX_SIZE);
 	SET_NETDEV_DEV(netdev, &spi->dev);
+
+	oa_tc6_framing_init();
+	if (framing_bench)
+		oa_tc6_framing_bench(&spi->dev);
+
 	mutex_init(&tc6->spi_ctrl_lock);
+	mutex_init(&tc6->reg_cache_lock);
+	mutex_init(&tc6->irq_thread_lock);
+	hash_init(tc6->reg_cache);
+	spin_lock_init(&tc6->ctrl_reqs_lock);
+	for (int i = 0; i < OA_TC6_CTRL_PRIOS; i++)
+		INIT_LIST_HEAD(&tc6->ctrl_reqs[i]);
+	u64_stats_init(&tc6->ctrl_syncp);
+	u64_stats_init(&tc6->err_syncp);
+	u64_stats_init(&tc6->data_syncp);
+	hrtimer_init(&tc6->launch_timer, CLOCK_REALTIME, HRTIMER_MODE_ABS);
+	tc6->launch_timer.function = oa_tc6_launch_timer;
+	tc6->launch_latency_ns = OA_TC6_LAUNCH_LATENCY_NS;
 
 	/* Set the SPI controller to pump at realtime priority */
 	tc6->spi->rt = true;
 	spi_setup(tc6->spi);
 
-	tc6->spi_ctrl_tx_buf = devm_kzalloc(&tc6->spi->dev,
-					    OA_TC6_CTRL_SPI_BUF_SIZE, GFP_KERNEL);
-	if (!tc6->spi_ctrl_tx_buf)
+	ret = oa_tc6_init_ctrl_buf(tc6, &tc6->spi_ctrl);
+	if (ret)
 		return NULL;
 
-	tc6->spi_ctrl_rx_buf = devm_kzalloc(&tc6->spi->dev,
-					    OA_TC6_CTRL_SPI_BUF_SIZE, GFP_KERNEL);
-	if (!tc6->spi_ctrl_rx_buf)
+	ret = oa_tc6_init_ctrl_buf(tc6, &tc6->spi_data_ctrl);
+	if (ret)
 		return NULL;
 
-	tc6->spi_data_tx_buf = devm_kzalloc(&tc6->spi->dev,
-					    OA_TC6_SPI_DATA_BUF_SIZE, GFP_KERNEL);
-	if (!tc6->spi_data_tx_buf)
+	tc6->spi_txn.tx_buf = devm_kcalloc(&tc6->spi->dev, OA_TC6_TXN_MAX_OPS,
+					   OA_TC6_CTRL_REG_SPI_SIZE,
+					   GFP_KERNEL);
+	if (!tc6->spi_txn.tx_buf)
 		return NULL;
 
-	tc6->spi_data_rx_buf = devm_kzalloc(&tc6->spi->dev,
-					    OA_TC6_SPI_DATA_BUF_SIZE, GFP_KERNEL);
-	if (!tc6->spi_data_rx_buf)
+	tc6->spi_txn.rx_buf = devm_kcalloc(&tc6->spi->dev, OA_TC6_TXN_MAX_OPS,
+					   OA_TC6_CTRL_REG_SPI_SIZE,
+					   GFP_KERNEL);
+	if (!tc6->spi_txn.rx_buf)
 		return NULL;
 
+	for (int i = 0; i < OA_TC6_SPI_DATA_BUFS; i++) {
+		ret = oa_tc6_init_spi_data_buf(tc6, &tc6->spi_data_bufs[i]);
+		if (ret)
+			return NULL;
+	}
+
 	ret = oa_tc6_sw_reset_macphy(tc6);
 	if (ret) {
 		dev_err(&tc6->spi->dev,
@@ -1236,10 +4212,17 @@ struct oa_tc6 *oa_tc6_init(struct spi_device *spi, struct net_device *netdev)
 		return NULL;
 	}
 
-	ret = oa_tc6_unmask_macphy_error_interrupts(tc6);
+	ret = oa_tc6_read_revision(tc6);
+	if (ret) {
+		dev_err(&tc6->spi->dev,
+			"MAC-PHY identification read failed: %d\n", ret);
+		return NULL;
+	}
+
+	ret = oa_tc6_unmask_macphy_interrupts(tc6);
 	if (ret) {
 		dev_err(&tc6->spi->dev,
-			"MAC-PHY error interrupts unmask failed: %d\n", ret);
+			"MAC-PHY interrupts unmask failed: %d\n", ret);
 		return NULL;
 	}
 
@@ -1264,26 +4247,31 @@ struct oa_tc6 *oa_tc6_init(struct spi_device *spi, struct net_device *netdev)
 		goto phy_exit;
 	}
 
-	skb_queue_head_init(&tc6->tx_skb_q);
-	init_waitqueue_head(&tc6->spi_wq);
+	__skb_queue_head_init(&tc6->rx_skb_list);
+	skb_queue_head_init(&tc6->rx_skb_q);
+	__skb_queue_head_init(&tc6->napi_rx_list);
 
-	tc6->spi_thread = kthread_run(oa_tc6_spi_thread_handler, tc6,
-				      "oa-tc6-spi-thread");
-	if (IS_ERR(tc6->spi_thread)) {
-		dev_err(&tc6->spi->dev, "Failed to create SPI thread\n");
+	ret = oa_tc6_create_page_pool(tc6);
+	if (ret) {
+		dev_err(&tc6->spi->dev, "Failed to create page pool: %d\n",
+			ret);
 		goto phy_exit;
 	}
 
-	sched_set_fifo(tc6->spi_thread);
+	netif_napi_add_weight(tc6->netdev, &tc6->napi, oa_tc6_napi_poll,
+			      OA_TC6_NAPI_WEIGHT);
+	napi_enable(&tc6->napi);
 
-	ret = devm_request_irq(&tc6->spi->dev, tc6->spi->irq, oa_tc6_macphy_isr,
-			       IRQF_TRIGGER_FALLING, dev_name(&tc6->spi->dev),
-			       tc6);
-	if (ret) {
-		dev_err(&tc6->spi->dev, "Failed to request macphy isr %d\n",
-			ret);
-		goto kthread_stop;
-	}
+	tc6->threaded_irq = threaded_irq;
+	if (tc6->threaded_irq)
+		ret = oa_tc6_request_threaded_irq(tc6);
+	else
+		ret = oa_tc6_join_spi_bus(tc6);
+	if (ret)
+		goto napi_del;
+
+	/* From now on the data engine performs the control requests */
+	oa_tc6_set_ctrl_state(tc6, OA_TC6_CTRL_QUEUED);
 
 	/* oa_tc6_sw_reset_macphy() function resets and clears the MAC-PHY reset
 	 * complete status. IRQ is also asserted on reset completion and it is
@@ -1291,13 +4279,14 @@ struct oa_tc6 *oa_tc6_init(struct spi_device *spi, struct net_device *netdev)
 	 * empty data chunk transmission will deassert the IRQ. Refer section
 	 * 7.7 and 9.2.8.8 in the OPEN Alliance specification for more details.
 	 */
-	tc6->int_flag = true;
-	wake_up_interruptible(&tc6->spi_wq);
+	oa_tc6_kick_spi_transfer(tc6, OA_TC6_EVENT_IRQ);
 
 	return tc6;
 
-kthread_stop:
-	kthread_stop(tc6->spi_thread);
+napi_del:
+	napi_disable(&tc6->napi);
+	netif_napi_del(&tc6->napi);
+	page_pool_destroy(tc6->page_pool);
 phy_exit:
 	oa_tc6_phy_exit(tc6);
 	return NULL;
@@ -1310,11 +4299,27 @@ EXPORT_SYMBOL_GPL(oa_tc6_init);
  */
 void oa_tc6_exit(struct oa_tc6 *tc6)
 {
+	struct sk_buff *skb;
+
+	oa_tc6_set_launch_time(tc6, false);
 	oa_tc6_phy_exit(tc6);
-	kthread_stop(tc6->spi_thread);
+	oa_tc6_set_ctrl_state(tc6, OA_TC6_CTRL_STOPPED);
+	devm_free_irq(&tc6->spi->dev, tc6->spi->irq, tc6);
+	if (!tc6->threaded_irq)
+		oa_tc6_bus_remove_port(tc6);
+	oa_tc6_flush_ctrl_reqs(tc6);
+	napi_disable(&tc6->napi);
+	netif_napi_del(&tc6->napi);
 	dev_kfree_skb_any(tc6->tx_skb);
 	dev_kfree_skb_any(tc6->rx_skb);
-	skb_queue_purge(&tc6->tx_skb_q);
+	dev_kfree_skb_any(tc6->tx_tstamp_skb);
+	while ((skb = oa_tc6_tx_ring_pop(tc6)))
+		dev_kfree_skb_any(skb);
+	netdev_reset_queue(tc6->netdev);
+	skb_queue_purge(&tc6->rx_skb_q);
+	__skb_queue_purge(&tc6->napi_rx_list);
+	page_pool_destroy(tc6->page_pool);
+	oa_tc6_reg_cache_drop(tc6);
 }
 EXPORT_SYMBOL_GPL(oa_tc6_exit);
 
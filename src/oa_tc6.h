@@ -7,11 +7,130 @@
  * Author: Parthiban Veerasooran <parthiban.veerasooran@microchip.com>
  */
 
+#ifndef _OA_TC6_H
+#define _OA_TC6_H
+
 #include <linux/etherdevice.h>
+#include <linux/net_tstamp.h>
 #include <linux/spi/spi.h>
 
+#define OA_TC6_TX_SKB_QUEUE_MAX_SIZE	64
+#define OA_TC6_BUS_WEIGHT_MAX		16
+#define OA_TC6_TXN_MAX_OPS		16
+#define OA_TC6_EVENT_CAPTURE_MAX_REGS	4
+
 struct oa_tc6;
 
+/* SPI bus usage of a device and of all the devices on its SPI controller */
+struct oa_tc6_bus_stats {
+	u64 port_time_ns;
+	u64 port_chunks;
+	u64 port_ctrl_xfers;
+	u64 bus_time_ns;
+};
+
+/* Control request latencies, the execution time stalls the data transfers */
+struct oa_tc6_ctrl_stats {
+	u64 reqs;
+	u64 wait_ns;
+	u64 wait_max_ns;
+	u64 exec_ns;
+	u64 exec_max_ns;
+};
+
+/* Framing errors, the resynchronizations of the data path they caused, the
+ * MAC-PHY resets, the frame timestamps which couldn't be delivered and the
+ * frames which missed their launch time
+ */
+struct oa_tc6_error_stats {
+	u64 loss_of_frame;
+	u64 header_error;
+	u64 rxd_header_bad;
+	u64 config_unsync;
+	u64 tx_protocol_error;
+	u64 footer_parity;
+	u64 recoveries;
+	u64 recovery_max_ns;
+	u64 resets;
+	u64 reset_max_ns;
+	u64 tx_tstamp_skipped; /* Another capture was ongoing */
+	u64 tx_tstamp_lost;
+	u64 rx_tstamp_parity;
+	u64 tx_launch_late; /* Released after their launch time */
+};
+
+/* SPI data transfers and the chunks they carried, the chunks without tx data
+ * were sent to receive or to read the footers only. The packet and byte
+ * counters are the ones of the network device.
+ */
+struct oa_tc6_data_stats {
+	u64 xfers;
+	u64 chunks;
+	u64 tx_chunks; /* With tx data */
+	u64 rx_chunks; /* With rx data */
+	u64 tx_credit_stalls; /* Tx frames waited for the MAC-PHY */
+	u64 rx_buf_overflows;
+	u64 ext_status_reads;
+	u64 rx_packets;
+	u64 rx_bytes;
+	u64 tx_packets;
+	u64 tx_bytes;
+};
+
+/* Priority of a control request against the data transfers */
+enum oa_tc6_ctrl_prio {
+	OA_TC6_CTRL_PRIO_HIGH, /* Before the next data transfer */
+	OA_TC6_CTRL_PRIO_NORMAL, /* Interleaved with the data transfers */
+	OA_TC6_CTRL_PRIO_LOW, /* When the data path is idle */
+};
+
+/* Control request queued to the data engine, private to oa_tc6 */
+struct oa_tc6_ctrl_req {
+	struct list_head node;
+	enum oa_tc6_ctrl_prio prio;
+	u64 submit_ns;
+	struct spi_message *msg; /* NULL for a transaction */
+	int ret;
+	void (*complete)(struct oa_tc6_ctrl_req *req);
+};
+
+enum oa_tc6_txn_op_type {
+	OA_TC6_TXN_READ,
+	OA_TC6_TXN_WRITE,
+	OA_TC6_TXN_UPDATE,
+};
+
+/* One register access of a control transaction. The value holds the read or
+ * written register value after the transaction is executed.
+ */
+struct oa_tc6_txn_op {
+	enum oa_tc6_txn_op_type type;
+	u32 address;
+	u32 mask;
+	u32 value;
+	int status;
+};
+
+/* Register accesses performed in order in one batched control transfer */
+struct oa_tc6_txn {
+	struct oa_tc6_txn_op ops[OA_TC6_TXN_MAX_OPS];
+	u8 count;
+	void (*complete)(struct oa_tc6_txn *txn, int status);
+	void *context;
+	struct oa_tc6_ctrl_req req;
+};
+
+/* MAC-PHY specific event, whose registers are read by the SPI data transfer
+ * loop when one of the STATUS1 bits is set
+ */
+struct oa_tc6_event_capture {
+	u32 status1;
+	u32 address; /* First of the consecutive event registers */
+	u8 length;
+	void (*handler)(struct oa_tc6_event_capture *capture, u32 status1,
+			u32 value[]);
+};
+
 struct oa_tc6 *oa_tc6_init(struct spi_device *spi, struct net_device *netdev);
 void oa_tc6_exit(struct oa_tc6 *tc6);
 int oa_tc6_write_register(struct oa_tc6 *tc6, u32 address, u32 value);
@@ -20,4 +139,44 @@ int oa_tc6_write_registers(struct oa_tc6 *tc6, u32 address, u32 value[],
 int oa_tc6_read_register(struct oa_tc6 *tc6, u32 address, u32 *value);
 int oa_tc6_read_registers(struct oa_tc6 *tc6, u32 address, u32 value[],
 			  u8 length);
+int oa_tc6_read_registers_sts(struct oa_tc6 *tc6, u32 address, u32 value[],
+			      u8 length, u8 index,
+			      struct ptp_system_timestamp *sts);
+int oa_tc6_update_register(struct oa_tc6 *tc6, u32 address, u32 mask,
+			   u32 value);
+void oa_tc6_txn_init(struct oa_tc6_txn *txn);
+int oa_tc6_txn_read(struct oa_tc6_txn *txn, u32 address);
+int oa_tc6_txn_write(struct oa_tc6_txn *txn, u32 address, u32 value);
+int oa_tc6_txn_update(struct oa_tc6_txn *txn, u32 address, u32 mask,
+		      u32 value);
+void oa_tc6_txn_submit(struct oa_tc6 *tc6, struct oa_tc6_txn *txn,
+		       enum oa_tc6_ctrl_prio prio,
+		       void (*complete)(struct oa_tc6_txn *txn, int status),
+		       void *context);
+int oa_tc6_txn_execute(struct oa_tc6 *tc6, struct oa_tc6_txn *txn,
+		       enum oa_tc6_ctrl_prio prio);
 netdev_tx_t oa_tc6_start_xmit(struct oa_tc6 *tc6, struct sk_buff *skb);
+int oa_tc6_set_tx_queue_size(struct oa_tc6 *tc6, u32 size);
+u32 oa_tc6_get_tx_queue_size(struct oa_tc6 *tc6);
+void oa_tc6_set_tx_zero_copy(struct oa_tc6 *tc6, bool enable);
+bool oa_tc6_get_tx_zero_copy(struct oa_tc6 *tc6);
+int oa_tc6_set_tx_packing(struct oa_tc6 *tc6, bool enable);
+bool oa_tc6_get_tx_packing(struct oa_tc6 *tc6);
+int oa_tc6_set_bus_weight(struct oa_tc6 *tc6, u32 weight);
+void oa_tc6_get_bus_stats(struct oa_tc6 *tc6, struct oa_tc6_bus_stats *stats);
+void oa_tc6_get_ctrl_stats(struct oa_tc6 *tc6, struct oa_tc6_ctrl_stats *stats);
+int oa_tc6_reset_macphy(struct oa_tc6 *tc6);
+int oa_tc6_restart_data(struct oa_tc6 *tc6);
+int oa_tc6_hwtstamp_set(struct oa_tc6 *tc6, struct hwtstamp_config *config);
+void oa_tc6_hwtstamp_get(struct oa_tc6 *tc6, struct hwtstamp_config *config);
+void oa_tc6_get_error_stats(struct oa_tc6 *tc6,
+			    struct oa_tc6_error_stats *stats);
+void oa_tc6_get_data_stats(struct oa_tc6 *tc6, struct oa_tc6_data_stats *stats);
+void oa_tc6_get_stats64(struct oa_tc6 *tc6, struct rtnl_link_stats64 *stats);
+void oa_tc6_set_launch_time(struct oa_tc6 *tc6, bool enable);
+void oa_tc6_set_phc_offset(struct oa_tc6 *tc6, s64 offset_ns);
+int oa_tc6_set_event_capture(struct oa_tc6 *tc6,
+			     struct oa_tc6_event_capture *capture);
+void oa_tc6_set_volatile_reg(struct oa_tc6 *tc6, bool (*volatile_reg)(u32));
+
+#endif /* _OA_TC6_H */
@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * OPEN Alliance 10BASE‑T1x MAC‑PHY Serial Interface data chunk framing
+ *
+ * Data headers are taken from a table of precomputed templates instead of
+ * being assembled and parity protected chunk by chunk, and the footers of a
+ * whole SPI data transfer are decoded in one pass, with NEON on arm64.
+ *
+ * Link: https://opensig.org/download/document/OPEN_Alliance_10BASET1x_MAC-PHY_Serial_Interface_V1.1.pdf
+ */
+
+#include <linux/bitfield.h>
+#include <linux/device.h>
+#include <linux/ktime.h>
+#include <linux/once.h>
+#include <linux/random.h>
+#include <linux/slab.h>
+#if defined(CONFIG_ARM64) && IS_ENABLED(CONFIG_KERNEL_MODE_NEON)
+#include <asm/neon.h>
+#include <asm/simd.h>
+#define OA_TC6_FRAMING_NEON
+#endif
+#include "oa_tc6_framing.h"
+
+#define OA_TC6_FRAMING_BENCH_LOOPS		1000
+
+__be32 oa_tc6_data_headers[OA_TC6_DATA_HEADERS] __read_mostly;
+__be32 oa_tc6_empty_data_header __read_mostly;
+
+#ifdef OA_TC6_FRAMING_NEON
+/* Picked once by oa_tc6_framing_bench(), read by all the devices */
+static bool oa_tc6_footers_neon __read_mostly = true;
+#endif
+
+__be32 oa_tc6_compute_data_header(bool data_valid, bool start_valid,
+				  bool end_valid, u8 end_byte_offset)
+{
+	u32 header = FIELD_PREP(OA_TC6_DATA_HEADER_DATA_NOT_CTRL, 1) |
+		     FIELD_PREP(OA_TC6_DATA_HEADER_DATA_VALID, data_valid) |
+		     FIELD_PREP(OA_TC6_DATA_HEADER_START_VALID, start_valid) |
+		     FIELD_PREP(OA_TC6_DATA_HEADER_END_VALID, end_valid) |
+		     FIELD_PREP(OA_TC6_DATA_HEADER_END_BYTE_OFFSET,
+				end_byte_offset);
+
+	header |= FIELD_PREP(OA_TC6_DATA_HEADER_PARITY,
+			     oa_tc6_get_parity(header));
+
+	return cpu_to_be32(header);
+}
+
+static void oa_tc6_build_data_headers(void)
+{
+	for (int i = 0; i < OA_TC6_DATA_HEADERS; i++)
+		oa_tc6_data_headers[i] =
+			oa_tc6_compute_data_header(true, i >> 7, (i >> 6) & 1,
+						   i & 0x3f);
+
+	oa_tc6_empty_data_header = oa_tc6_compute_data_header(false, false,
+							      false, 0);
+}
+
+void oa_tc6_framing_init(void)
+{
+	DO_ONCE(oa_tc6_build_data_headers);
+}
+
+void oa_tc6_classify_footers_scalar(const u8 *rx_buf, unsigned int first,
+				    unsigned int chunks,
+				    struct oa_tc6_rx_footers *footers)
+{
+	for (unsigned int i = first; i < chunks; i++) {
+		const __be32 *p = (const __be32 *)(rx_buf +
+						   i * OA_TC6_CHUNK_SIZE +
+						   OA_TC6_CHUNK_PAYLOAD_SIZE);
+		u32 footer = be32_to_cpup(p);
+		bool bad = !(hweight32(footer) & 1);
+		bool exc = bad || !(footer & OA_TC6_DATA_FOOTER_CONFIG_SYNC) ||
+			   (footer & (OA_TC6_DATA_FOOTER_EXTENDED_STS |
+				      OA_TC6_DATA_FOOTER_RXD_HEADER_BAD));
+
+		footers->footer[i] = footer;
+		footers->data_valid |=
+			(u64)!!(footer & OA_TC6_DATA_FOOTER_DATA_VALID) << i;
+		footers->exceptions |= (u64)exc << i;
+		footers->bad_parity |= (u64)bad << i;
+	}
+}
+
+static void __oa_tc6_classify_footers(const u8 *rx_buf, unsigned int chunks,
+				      struct oa_tc6_rx_footers *footers,
+				      bool neon)
+{
+	unsigned int done = 0;
+
+	footers->data_valid = 0;
+	footers->exceptions = 0;
+	footers->bad_parity = 0;
+
+#ifdef OA_TC6_FRAMING_NEON
+	if (neon && chunks >= 4 && may_use_simd()) {
+		kernel_neon_begin();
+		done = oa_tc6_classify_footers_neon(rx_buf, chunks, footers);
+		kernel_neon_end();
+	}
+#endif
+
+	oa_tc6_classify_footers_scalar(rx_buf, done, chunks, footers);
+}
+
+void oa_tc6_classify_footers(const u8 *rx_buf, unsigned int chunks,
+			     struct oa_tc6_rx_footers *footers)
+{
+#ifdef OA_TC6_FRAMING_NEON
+	__oa_tc6_classify_footers(rx_buf, chunks, footers,
+				  READ_ONCE(oa_tc6_footers_neon));
+#else
+	__oa_tc6_classify_footers(rx_buf, chunks, footers, false);
+#endif
+}
+
+/* The framing before the bulk engine: every header is assembled and parity
+ * protected on its own, every footer is fetched and decoded on its own.
+ */
+static void oa_tc6_bench_per_chunk(u8 *tx_buf, const u8 *rx_buf,
+				   struct oa_tc6_rx_footers *footers, bool neon)
+{
+	for (int i = 0; i < OA_TC6_MAX_TX_CHUNKS; i++) {
+		__be32 *header = (__be32 *)(tx_buf + i * OA_TC6_CHUNK_SIZE);
+		const __be32 *p = (const __be32 *)(rx_buf +
+						   i * OA_TC6_CHUNK_SIZE +
+						   OA_TC6_CHUNK_PAYLOAD_SIZE);
+		u32 footer = be32_to_cpup(p);
+
+		*header = oa_tc6_compute_data_header(true, i == 0,
+						     i == OA_TC6_MAX_TX_CHUNKS - 1,
+						     i);
+		footers->footer[i] = footer;
+		if (FIELD_GET(OA_TC6_DATA_FOOTER_DATA_VALID, footer))
+			footers->data_valid |= BIT_ULL(i);
+		if (FIELD_GET(OA_TC6_DATA_FOOTER_EXTENDED_STS, footer) ||
+		    FIELD_GET(OA_TC6_DATA_FOOTER_RXD_HEADER_BAD, footer) ||
+		    !FIELD_GET(OA_TC6_DATA_FOOTER_CONFIG_SYNC, footer))
+			footers->exceptions |= BIT_ULL(i);
+	}
+}
+
+static void oa_tc6_bench_bulk(u8 *tx_buf, const u8 *rx_buf,
+			      struct oa_tc6_rx_footers *footers, bool neon)
+{
+	for (int i = 0; i < OA_TC6_MAX_TX_CHUNKS; i++) {
+		__be32 *header = (__be32 *)(tx_buf + i * OA_TC6_CHUNK_SIZE);
+
+		*header = oa_tc6_data_header(i == 0,
+					     i == OA_TC6_MAX_TX_CHUNKS - 1, i);
+	}
+
+	__oa_tc6_classify_footers(rx_buf, OA_TC6_MAX_TX_CHUNKS, footers, neon);
+}
+
+static u64 oa_tc6_bench_run(void (*framing)(u8 *tx_buf, const u8 *rx_buf,
+					    struct oa_tc6_rx_footers *footers,
+					    bool neon),
+			    u8 *tx_buf, const u8 *rx_buf,
+			    struct oa_tc6_rx_footers *footers, bool neon)
+{
+	u64 start = ktime_get_ns();
+
+	for (int i = 0; i < OA_TC6_FRAMING_BENCH_LOOPS; i++) {
+		footers->data_valid = 0;
+		footers->exceptions = 0;
+		framing(tx_buf, rx_buf, footers, neon);
+	}
+
+	return div_u64(ktime_get_ns() - start, OA_TC6_FRAMING_BENCH_LOOPS);
+}
+
+/**
+ * oa_tc6_framing_bench - microbenchmark of the chunk framing.
+ * @dev: device the results are logged for.
+ *
+ * Frames a full SPI data transfer of random footers with the per chunk path
+ * and the bulk engine, scalar and NEON where available, and logs the time per
+ * transfer. The faster footer decoder is used from then on.
+ */
+void oa_tc6_framing_bench(struct device *dev)
+{
+	struct oa_tc6_rx_footers *footers;
+	u64 per_chunk_ns, scalar_ns;
+	u8 *tx_buf, *rx_buf;
+
+	footers = kmalloc(sizeof(*footers), GFP_KERNEL);
+	tx_buf = kmalloc(OA_TC6_MAX_TX_CHUNKS * OA_TC6_CHUNK_SIZE, GFP_KERNEL);
+	rx_buf = kmalloc(OA_TC6_MAX_TX_CHUNKS * OA_TC6_CHUNK_SIZE, GFP_KERNEL);
+	if (!footers || !tx_buf || !rx_buf)
+		goto free;
+
+	get_random_bytes(rx_buf, OA_TC6_MAX_TX_CHUNKS * OA_TC6_CHUNK_SIZE);
+
+	per_chunk_ns = oa_tc6_bench_run(oa_tc6_bench_per_chunk, tx_buf,
+					rx_buf, footers, false);
+	scalar_ns = oa_tc6_bench_run(oa_tc6_bench_bulk, tx_buf, rx_buf,
+				     footers, false);
+
+#ifdef OA_TC6_FRAMING_NEON
+	if (may_use_simd()) {
+		u64 neon_ns;
+
+		/* Other devices may be decoding footers meanwhile, so the
+		 * decoder is only switched once the result is known.
+		 */
+		neon_ns = oa_tc6_bench_run(oa_tc6_bench_bulk, tx_buf, rx_buf,
+					   footers, true);
+		WRITE_ONCE(oa_tc6_footers_neon, neon_ns < scalar_ns);
+		dev_info(dev,
+			 "Framing of %d chunks: per chunk %llu ns, bulk %llu ns, bulk NEON %llu ns\n",
+			 OA_TC6_MAX_TX_CHUNKS, per_chunk_ns, scalar_ns,
+			 neon_ns);
+		goto free;
+	}
+#endif
+	dev_info(dev, "Framing of %d chunks: per chunk %llu ns, bulk %llu ns\n",
+		 OA_TC6_MAX_TX_CHUNKS, per_chunk_ns, scalar_ns);
+
+free:
+	kfree(rx_buf);
+	kfree(tx_buf);
+	kfree(footers);
+}
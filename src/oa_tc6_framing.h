@@ -0,0 +1,130 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * OPEN Alliance 10BASE‑T1x MAC‑PHY Serial Interface data chunk framing
+ *
+ * Link: https://opensig.org/download/document/OPEN_Alliance_10BASET1x_MAC-PHY_Serial_Interface_V1.1.pdf
+ */
+
+#ifndef _OA_TC6_FRAMING_H
+#define _OA_TC6_FRAMING_H
+
+#include <linux/bitfield.h>
+#include <linux/bitops.h>
+#include <linux/bits.h>
+#include <linux/types.h>
+
+/* Data header */
+#define OA_TC6_DATA_HEADER_DATA_NOT_CTRL	BIT(31)
+#define OA_TC6_DATA_HEADER_DATA_VALID		BIT(21)
+#define OA_TC6_DATA_HEADER_START_VALID		BIT(20)
+#define OA_TC6_DATA_HEADER_START_WORD_OFFSET	GENMASK(19, 16)
+#define OA_TC6_DATA_HEADER_END_VALID		BIT(14)
+#define OA_TC6_DATA_HEADER_END_BYTE_OFFSET	GENMASK(13, 8)
+#define OA_TC6_DATA_HEADER_TIMESTAMP_CAPTURE	GENMASK(7, 6)
+#define OA_TC6_DATA_HEADER_PARITY		BIT(0)
+
+/* Data footer */
+#define OA_TC6_DATA_FOOTER_EXTENDED_STS		BIT(31)
+#define OA_TC6_DATA_FOOTER_RXD_HEADER_BAD	BIT(30)
+#define OA_TC6_DATA_FOOTER_CONFIG_SYNC		BIT(29)
+#define OA_TC6_DATA_FOOTER_RX_CHUNKS_AVAILABLE	GENMASK(28, 24)
+#define OA_TC6_DATA_FOOTER_DATA_VALID		BIT(21)
+#define OA_TC6_DATA_FOOTER_START_VALID		BIT(20)
+#define OA_TC6_DATA_FOOTER_START_WORD_OFFSET	GENMASK(19, 16)
+#define OA_TC6_DATA_FOOTER_END_VALID		BIT(14)
+#define OA_TC6_DATA_FOOTER_END_BYTE_OFFSET	GENMASK(13, 8)
+#define OA_TC6_DATA_FOOTER_RX_TIMESTAMP_ADDED	BIT(7)
+#define OA_TC6_DATA_FOOTER_RX_TIMESTAMP_PARITY	BIT(6)
+#define OA_TC6_DATA_FOOTER_TX_CREDITS		GENMASK(5, 1)
+#define OA_TC6_DATA_FOOTER_PARITY		BIT(0)
+
+#define OA_TC6_CHUNK_PAYLOAD_SIZE		64
+#define OA_TC6_DATA_HEADER_SIZE			4
+#define OA_TC6_CHUNK_SIZE			(OA_TC6_DATA_HEADER_SIZE +\
+						OA_TC6_CHUNK_PAYLOAD_SIZE)
+#define OA_TC6_MAX_TX_CHUNKS			48
+
+/* Data valid headers are indexed by start valid, end valid and end byte
+ * offset.
+ */
+#define OA_TC6_DATA_HEADERS			256
+
+struct device;
+
+/* Footers of the chunks of one SPI data transfer, decoded in one pass. Only
+ * the chunks with valid data or with an exceptional footer, that is extended
+ * status, received header bad, configuration unsync or a parity error, need
+ * to be looked at one by one.
+ */
+struct oa_tc6_rx_footers {
+	u32 footer[OA_TC6_MAX_TX_CHUNKS]; /* In CPU byte order */
+	u64 data_valid;
+	u64 exceptions;
+	u64 bad_parity;
+};
+
+extern __be32 oa_tc6_data_headers[OA_TC6_DATA_HEADERS];
+extern __be32 oa_tc6_empty_data_header;
+
+static inline int oa_tc6_get_parity(u32 p)
+{
+	/* Public domain code snippet, lifted from
+	 * http://www-graphics.stanford.edu/~seander/bithacks.html
+	 */
+	p ^= p >> 1;
+	p ^= p >> 2;
+	p = (p & 0x11111111U) * 0x11111111U;
+
+	/* Odd parity is used here */
+	return !((p >> 28) & 1);
+}
+
+static inline __be32 oa_tc6_data_header(bool start_valid, bool end_valid,
+					u8 end_byte_offset)
+{
+	return oa_tc6_data_headers[start_valid << 7 | end_valid << 6 |
+				   end_byte_offset];
+}
+
+/* Header of a chunk with the end of a frame followed by the start of the next
+ * one at the start word offset.
+ */
+static inline __be32 oa_tc6_packed_data_header(u8 start_word_offset,
+					       u8 end_byte_offset)
+{
+	u32 swo = FIELD_PREP(OA_TC6_DATA_HEADER_START_WORD_OFFSET,
+			     start_word_offset);
+
+	/* Every set bit of the start word offset flips the parity */
+	if (hweight8(start_word_offset) & 1)
+		swo |= OA_TC6_DATA_HEADER_PARITY;
+
+	return oa_tc6_data_header(true, true, end_byte_offset) ^
+	       cpu_to_be32(swo);
+}
+
+/* Header of a chunk with a frame start whose transmit timestamp is to be
+ * captured into the TTSCA registers.
+ */
+static inline __be32 oa_tc6_tstamp_data_header(__be32 header)
+{
+	/* Capture A is a single set bit, which flips the parity */
+	return header ^
+	       cpu_to_be32(FIELD_PREP(OA_TC6_DATA_HEADER_TIMESTAMP_CAPTURE, 1) |
+			   OA_TC6_DATA_HEADER_PARITY);
+}
+
+void oa_tc6_framing_init(void);
+__be32 oa_tc6_compute_data_header(bool data_valid, bool start_valid,
+				  bool end_valid, u8 end_byte_offset);
+void oa_tc6_classify_footers(const u8 *rx_buf, unsigned int chunks,
+			     struct oa_tc6_rx_footers *footers);
+void oa_tc6_classify_footers_scalar(const u8 *rx_buf, unsigned int first,
+				    unsigned int chunks,
+				    struct oa_tc6_rx_footers *footers);
+unsigned int oa_tc6_classify_footers_neon(const u8 *rx_buf,
+					  unsigned int chunks,
+					  struct oa_tc6_rx_footers *footers);
+void oa_tc6_framing_bench(struct device *dev);
+
+#endif /* _OA_TC6_FRAMING_H */
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * OPEN Alliance 10BASE‑T1x MAC‑PHY Serial Interface footer decoding with NEON
+ *
+ * Called between kernel_neon_begin() and kernel_neon_end() only.
+ */
+
+#include <asm/neon-intrinsics.h>
+#include "oa_tc6_framing.h"
+
+/* Returns the number of decoded footers, a multiple of four */
+unsigned int oa_tc6_classify_footers_neon(const u8 *rx_buf,
+					  unsigned int chunks,
+					  struct oa_tc6_rx_footers *footers)
+{
+	const uint32x4_t lanes = { 1, 2, 4, 8 };
+	const uint32x4_t data_valid = vdupq_n_u32(OA_TC6_DATA_FOOTER_DATA_VALID);
+	const uint32x4_t errors = vdupq_n_u32(OA_TC6_DATA_FOOTER_EXTENDED_STS |
+					      OA_TC6_DATA_FOOTER_RXD_HEADER_BAD);
+	const uint32x4_t sync = vdupq_n_u32(OA_TC6_DATA_FOOTER_CONFIG_SYNC);
+	const uint32x4_t one = vdupq_n_u32(1);
+	const uint32x4_t zero = vdupq_n_u32(0);
+	unsigned int i;
+
+	for (i = 0; i + 4 <= chunks; i += 4) {
+		const u8 *p = rx_buf + i * OA_TC6_CHUNK_SIZE +
+			      OA_TC6_CHUNK_PAYLOAD_SIZE;
+		uint32x4_t footer = zero;
+		uint32x4_t bad, exc, dv;
+
+		/* The footers are a chunk apart, gather four of them */
+		footer = vld1q_lane_u32((const u32 *)p, footer, 0);
+		footer = vld1q_lane_u32((const u32 *)(p + OA_TC6_CHUNK_SIZE),
+					footer, 1);
+		footer = vld1q_lane_u32((const u32 *)(p + 2 * OA_TC6_CHUNK_SIZE),
+					footer, 2);
+		footer = vld1q_lane_u32((const u32 *)(p + 3 * OA_TC6_CHUNK_SIZE),
+					footer, 3);
+		footer = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(footer)));
+		vst1q_u32(&footers->footer[i], footer);
+
+		/* Odd parity, the number of set bits in a footer is odd */
+		bad = vpaddlq_u16(vpaddlq_u8(vcntq_u8(vreinterpretq_u8_u32(footer))));
+		bad = vceqq_u32(vandq_u32(bad, one), zero);
+
+		exc = vorrq_u32(vtstq_u32(footer, errors),
+				vceqq_u32(vandq_u32(footer, sync), zero));
+		exc = vorrq_u32(exc, bad);
+		dv = vtstq_u32(footer, data_valid);
+
+		footers->data_valid |= (u64)vaddvq_u32(vandq_u32(dv, lanes)) << i;
+		footers->exceptions |= (u64)vaddvq_u32(vandq_u32(exc, lanes)) << i;
+		footers->bad_parity |= (u64)vaddvq_u32(vandq_u32(bad, lanes)) << i;
+	}
+
+	return i;
+}
@@ -0,0 +1,238 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * OPEN Alliance 10BASE‑T1x MAC‑PHY Serial Interface trace events
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM oa_tc6
+
+#if !defined(_OA_TC6_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _OA_TC6_TRACE_H
+
+#include <linux/netdevice.h>
+#include <linux/skbuff.h>
+#include <linux/tracepoint.h>
+#include <linux/version.h>
+
+/* __assign_str() takes the source from __string() since Linux 6.10 */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 10, 0)
+#define oa_tc6_assign_name(netdev)	__assign_str(name)
+#else
+#define oa_tc6_assign_name(netdev)	__assign_str(name, netdev_name(netdev))
+#endif
+
+/* An SPI data transfer is queued to the SPI controller. The chunks without tx
+ * data only receive or read the footers. The tx credits and rx chunks
+ * available are the ones left for the next transfer.
+ */
+TRACE_EVENT(oa_tc6_spi_xfer_start,
+	TP_PROTO(const struct net_device *netdev, u16 chunks, u16 tx_chunks,
+		 u16 tx_credits, u8 rx_chunks_available),
+
+	TP_ARGS(netdev, chunks, tx_chunks, tx_credits, rx_chunks_available),
+
+	TP_STRUCT__entry(
+		__string(name, netdev_name(netdev))
+		__field(u16, chunks)
+		__field(u16, tx_chunks)
+		__field(u16, tx_credits)
+		__field(u8, rx_chunks_available)
+	),
+
+	TP_fast_assign(
+		oa_tc6_assign_name(netdev);
+		__entry->chunks = chunks;
+		__entry->tx_chunks = tx_chunks;
+		__entry->tx_credits = tx_credits;
+		__entry->rx_chunks_available = rx_chunks_available;
+	),
+
+	TP_printk("%s: chunks=%u tx=%u empty=%u tx_credits=%u rx_chunks_available=%u",
+		  __get_str(name), __entry->chunks, __entry->tx_chunks,
+		  __entry->chunks - __entry->tx_chunks, __entry->tx_credits,
+		  __entry->rx_chunks_available)
+);
+
+/* The received chunks of an SPI data transfer are processed. The tx credits
+ * and rx chunks available are the ones of its last footer.
+ */
+TRACE_EVENT(oa_tc6_spi_xfer_end,
+	TP_PROTO(const struct net_device *netdev, u16 chunks, u16 rx_chunks,
+		 u16 tx_credits, u8 rx_chunks_available, int ret),
+
+	TP_ARGS(netdev, chunks, rx_chunks, tx_credits, rx_chunks_available,
+		ret),
+
+	TP_STRUCT__entry(
+		__string(name, netdev_name(netdev))
+		__field(u16, chunks)
+		__field(u16, rx_chunks)
+		__field(u16, tx_credits)
+		__field(u8, rx_chunks_available)
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		oa_tc6_assign_name(netdev);
+		__entry->chunks = chunks;
+		__entry->rx_chunks = rx_chunks;
+		__entry->tx_credits = tx_credits;
+		__entry->rx_chunks_available = rx_chunks_available;
+		__entry->ret = ret;
+	),
+
+	TP_printk("%s: chunks=%u rx=%u tx_credits=%u rx_chunks_available=%u ret=%d",
+		  __get_str(name), __entry->chunks, __entry->rx_chunks,
+		  __entry->tx_credits, __entry->rx_chunks_available,
+		  __entry->ret)
+);
+
+DECLARE_EVENT_CLASS(oa_tc6_frame,
+	TP_PROTO(const struct net_device *netdev, const struct sk_buff *skb),
+
+	TP_ARGS(netdev, skb),
+
+	TP_STRUCT__entry(
+		__string(name, netdev_name(netdev))
+		__field(const void *, skbaddr)
+		__field(unsigned int, len)
+	),
+
+	TP_fast_assign(
+		oa_tc6_assign_name(netdev);
+		__entry->skbaddr = skb;
+		__entry->len = skb->len;
+	),
+
+	TP_printk("%s: skbaddr=%p len=%u", __get_str(name), __entry->skbaddr,
+		  __entry->len)
+);
+
+/* A tx frame is added to the tx ring by ndo_start_xmit */
+DEFINE_EVENT(oa_tc6_frame, oa_tc6_tx_enqueue,
+	TP_PROTO(const struct net_device *netdev, const struct sk_buff *skb),
+	TP_ARGS(netdev, skb)
+);
+
+/* The first chunk of a tx frame is added to an SPI data transfer */
+DEFINE_EVENT(oa_tc6_frame, oa_tc6_tx_frame_start,
+	TP_PROTO(const struct net_device *netdev, const struct sk_buff *skb),
+	TP_ARGS(netdev, skb)
+);
+
+/* The last chunk of a tx frame is added to an SPI data transfer */
+DEFINE_EVENT(oa_tc6_frame, oa_tc6_tx_frame_end,
+	TP_PROTO(const struct net_device *netdev, const struct sk_buff *skb),
+	TP_ARGS(netdev, skb)
+);
+
+/* A received frame is complete and queued for NAPI delivery */
+DEFINE_EVENT(oa_tc6_frame, oa_tc6_rx_frame,
+	TP_PROTO(const struct net_device *netdev, const struct sk_buff *skb),
+	TP_ARGS(netdev, skb)
+);
+
+/* The MAC-PHY interrupt arrived */
+TRACE_EVENT(oa_tc6_irq,
+	TP_PROTO(const struct net_device *netdev),
+
+	TP_ARGS(netdev),
+
+	TP_STRUCT__entry(
+		__string(name, netdev_name(netdev))
+	),
+
+	TP_fast_assign(
+		oa_tc6_assign_name(netdev);
+	),
+
+	TP_printk("%s", __get_str(name))
+);
+
+/* A control transfer of consecutive registers is done. The duration includes
+ * the wait for the data engine if the transfer was queued to it.
+ */
+TRACE_EVENT(oa_tc6_ctrl_access,
+	TP_PROTO(const struct net_device *netdev, u32 address, u8 length,
+		 bool write, u64 duration_ns, int ret),
+
+	TP_ARGS(netdev, address, length, write, duration_ns, ret),
+
+	TP_STRUCT__entry(
+		__string(name, netdev_name(netdev))
+		__field(u32, address)
+		__field(u8, length)
+		__field(bool, write)
+		__field(u64, duration_ns)
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		oa_tc6_assign_name(netdev);
+		__entry->address = address;
+		__entry->length = length;
+		__entry->write = write;
+		__entry->duration_ns = duration_ns;
+		__entry->ret = ret;
+	),
+
+	TP_printk("%s: %s address=0x%08x length=%u duration_ns=%llu ret=%d",
+		  __get_str(name), __entry->write ? "write" : "read",
+		  __entry->address, __entry->length, __entry->duration_ns,
+		  __entry->ret)
+);
+
+/* The control commands of a transaction are done in one SPI transfer */
+TRACE_EVENT(oa_tc6_ctrl_txn,
+	TP_PROTO(const struct net_device *netdev, u8 cmds, u64 duration_ns,
+		 int ret),
+
+	TP_ARGS(netdev, cmds, duration_ns, ret),
+
+	TP_STRUCT__entry(
+		__string(name, netdev_name(netdev))
+		__field(u8, cmds)
+		__field(u64, duration_ns)
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		oa_tc6_assign_name(netdev);
+		__entry->cmds = cmds;
+		__entry->duration_ns = duration_ns;
+		__entry->ret = ret;
+	),
+
+	TP_printk("%s: cmds=%u duration_ns=%llu ret=%d", __get_str(name),
+		  __entry->cmds, __entry->duration_ns, __entry->ret)
+);
+
+/* The extended status of a footer was read from STATUS0 and STATUS1 */
+TRACE_EVENT(oa_tc6_ext_status,
+	TP_PROTO(const struct net_device *netdev, u32 status0, u32 status1),
+
+	TP_ARGS(netdev, status0, status1),
+
+	TP_STRUCT__entry(
+		__string(name, netdev_name(netdev))
+		__field(u32, status0)
+		__field(u32, status1)
+	),
+
+	TP_fast_assign(
+		oa_tc6_assign_name(netdev);
+		__entry->status0 = status0;
+		__entry->status1 = status1;
+	),
+
+	TP_printk("%s: status0=0x%08x status1=0x%08x", __get_str(name),
+		  __entry->status0, __entry->status1)
+);
+
+#endif /* _OA_TC6_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE oa_tc6_trace
+#include <trace/define_trace.h>